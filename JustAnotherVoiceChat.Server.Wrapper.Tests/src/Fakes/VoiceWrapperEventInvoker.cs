@@ -264,5 +264,85 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Tests.Fakes
         {
             return Mock.Object.IsClientConnected(client);
         }
+
+        public void SetWorkerThreadCount(int threadCount)
+        {
+            Mock.Object.SetWorkerThreadCount(threadCount);
+        }
+
+        public void SetPairwiseEvaluation(bool enabled)
+        {
+            Mock.Object.SetPairwiseEvaluation(enabled);
+        }
+
+        public void SetAudibleRangeFactors(float enterFactor, float exitFactor)
+        {
+            Mock.Object.SetAudibleRangeFactors(enterFactor, exitFactor);
+        }
+
+        public void SetTickRate(int tickRate)
+        {
+            Mock.Object.SetTickRate(tickRate);
+        }
+
+        public int GetTickRate()
+        {
+            return Mock.Object.GetTickRate();
+        }
+
+        public ulong GetTickOverrunCount()
+        {
+            return Mock.Object.GetTickOverrunCount();
+        }
+
+        public void SetPositionLevelOfDetail(float nearFactor, int farInterval)
+        {
+            Mock.Object.SetPositionLevelOfDetail(nearFactor, farInterval);
+        }
+
+        public void SetAudibleClientLimit(int limit, bool preferTalking)
+        {
+            Mock.Object.SetAudibleClientLimit(limit, preferTalking);
+        }
+
+        public bool SetClientDimension(IVoiceClient client, int dimension)
+        {
+            return Mock.Object.SetClientDimension(client, dimension);
+        }
+
+        public bool SetClientDimensions(IEnumerable<ClientDimension> clientDimensions)
+        {
+            return Mock.Object.SetClientDimensions(clientDimensions);
+        }
+
+        public ulong GetTickDuration()
+        {
+            return Mock.Object.GetTickDuration();
+        }
+
+        public void SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval)
+        {
+            Mock.Object.SetPositionUpdateThreshold(distance, rotation, heartbeatInterval);
+        }
+
+        public ulong GetTickSendLatency()
+        {
+            return Mock.Object.GetTickSendLatency();
+        }
+
+        public void SetNetworkShardCount(int shardCount)
+        {
+            Mock.Object.SetNetworkShardCount(shardCount);
+        }
+
+        public int GetNetworkShardCount()
+        {
+            return Mock.Object.GetNetworkShardCount();
+        }
+
+        public ushort GetClientPort(IVoiceClient client)
+        {
+            return Mock.Object.GetClientPort(client);
+        }
     }
 }
@@ -50,6 +50,11 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Client
             return new ClientPosition(Handle.Identifer, position.X, position.Y, position.Z, CameraRotation);
         }
 
+        public ClientDimension MakeClientDimension(int dimension)
+        {
+            return new ClientDimension(Handle.Identifer, dimension);
+        }
+
         public bool SetRelativeSpeakerPosition(IVoiceClient speaker, Vector3 position)
         {
             return RunWhenConnected(() => Server.NativeWrapper.SetRelativeSpeakerPositionForListener(this, speaker, position));
@@ -69,5 +74,10 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Client
         {
             return RunWhenConnected(() => Server.NativeWrapper.SetClientVoiceRange(this, range));
         }
+
+        public bool SetDimension(int dimension)
+        {
+            return RunWhenConnected(() => Server.NativeWrapper.SetClientDimension(this, dimension));
+        }
     }
 }
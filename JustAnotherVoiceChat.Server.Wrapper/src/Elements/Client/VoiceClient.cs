@@ -58,7 +58,15 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Client
             Microphone = true;
 
             var config = Server.Configuration;
-            HandshakeUrl = $"http://localhost:23333/?host={config.Hostname}&port={config.Port}&uid={Handle.Identifer}";
+
+            // clients are spread over the ports of all network shards, without a native server the configured port is used
+            var port = Server.NativeWrapper.GetClientPort(this);
+            if (port == 0)
+            {
+                port = config.Port;
+            }
+
+            HandshakeUrl = $"http://localhost:23333/?host={config.Hostname}&port={port}&uid={Handle.Identifer}";
             
             AttachToStatusChangeEvents();
         }
@@ -32,6 +32,7 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Models
 {
     public class VoiceServerConfiguration
     {
+        public const int DefaultMaxClients = 256;
         
         public string Hostname { get; }
         public ushort Port { get; }
@@ -44,12 +45,19 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Models
         public float GlobalDistanceFactor { get; }
         public double GlobalMaxDistance { get; }
 
+        public int MaxClients { get; }
+
         public VoiceServerConfiguration(string hostname, ushort port, string teamspeakServerId, ulong teamspeakChannelId, string teamspeakChannelPassword)
             : this(hostname, port, teamspeakServerId, teamspeakChannelId, teamspeakChannelPassword, 1, 1, 10f)
         {
         }
 
         public VoiceServerConfiguration(string hostname, ushort port, string teamspeakServerId, ulong teamspeakChannelId, string teamspeakChannelPassword, float globalRollOffScale, float globalDistanceFactor, double globalMaxDistance)
+            : this(hostname, port, teamspeakServerId, teamspeakChannelId, teamspeakChannelPassword, globalRollOffScale, globalDistanceFactor, globalMaxDistance, DefaultMaxClients)
+        {
+        }
+
+        public VoiceServerConfiguration(string hostname, ushort port, string teamspeakServerId, ulong teamspeakChannelId, string teamspeakChannelPassword, float globalRollOffScale, float globalDistanceFactor, double globalMaxDistance, int maxClients)
         {
             if (string.IsNullOrWhiteSpace(hostname) || Uri.CheckHostName(hostname) == UriHostNameType.Unknown)
             {
@@ -60,6 +68,11 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Models
             {
                 throw new ArgumentException($"The provided teamspeakServerId \"{teamspeakServerId}\" is invalid!");
             }
+
+            if (maxClients < 1)
+            {
+                throw new ArgumentException($"The provided maxClients \"{maxClients}\" is invalid!");
+            }
             
             Hostname = hostname;
             Port = port;
@@ -71,6 +84,8 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Models
             GlobalRollOffScale = globalRollOffScale;
             GlobalDistanceFactor = globalDistanceFactor;
             GlobalMaxDistance = globalMaxDistance;
+
+            MaxClients = maxClients;
         }
         
     }
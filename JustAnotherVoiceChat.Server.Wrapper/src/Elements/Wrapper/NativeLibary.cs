@@ -44,6 +44,9 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
         [DllImport(JustAnotherVoiceChatLibrary)]
         internal static extern void JV_CreateServer(ushort port, string teamspeakServerId, ulong teamspeakChannelId, string teamspeakChannelPassword);
 
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_CreateServerWithMaxClients(ushort port, string teamspeakServerId, ulong teamspeakChannelId, string teamspeakChannelPassword, int maxClients);
+
         [DllImport(JustAnotherVoiceChatLibrary)]
         internal static extern void JV_DestroyServer();
 
@@ -169,6 +172,14 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
         [return: MarshalAs(UnmanagedType.I1)]
         internal static extern bool JV_SetClientPositions(ClientPosition[] clientPositions, int length);
 
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        internal static extern bool JV_SetClientDimension(ushort clientId, int dimension);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        internal static extern bool JV_SetClientDimensions(ClientDimension[] clientDimensions, int length);
+
         [DllImport(JustAnotherVoiceChatLibrary)]
         [return: MarshalAs(UnmanagedType.I1)]
         internal static extern bool JV_SetRelativePositionForClient(ushort listenerId, ushort speakerId, float x, float y, float z);
@@ -201,5 +212,51 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
         [return: MarshalAs(UnmanagedType.I1)]
         internal static extern bool JV_IsClientMutedForClient(ushort speakerId, ushort listenerId);
 
+        /**
+         * Settings
+         */
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetWorkerThreadCount(int threadCount);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetPairwiseEvaluation(bool enabled);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetAudibleRangeFactors(float enterFactor, float exitFactor);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetTickRate(int tickRate);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern int JV_GetTickRate();
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern ulong JV_GetTickOverrunCount();
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetPositionLevelOfDetail(float nearFactor, int farInterval);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetAudibleClientLimit(int limit, bool preferTalking);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern ulong JV_GetTickDuration();
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern ulong JV_GetTickSendLatency();
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern void JV_SetNetworkShardCount(int shardCount);
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern int JV_GetNetworkShardCount();
+
+        [DllImport(JustAnotherVoiceChatLibrary)]
+        internal static extern ushort JV_GetClientPort(ushort gameId);
+
     }
 }
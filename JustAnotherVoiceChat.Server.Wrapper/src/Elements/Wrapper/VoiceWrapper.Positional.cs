@@ -57,6 +57,17 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
             return NativeLibary.JV_SetClientPositions(positions, positions.Length);
         }
 
+        public bool SetClientDimension(IVoiceClient client, int dimension)
+        {
+            return NativeLibary.JV_SetClientDimension(client.Handle.Identifer, dimension);
+        }
+
+        public bool SetClientDimensions(IEnumerable<ClientDimension> clientDimensions)
+        {
+            var dimensions = clientDimensions.ToArray();
+            return NativeLibary.JV_SetClientDimensions(dimensions, dimensions.Length);
+        }
+
         public bool SetRelativeSpeakerPositionForListener(IVoiceClient listener, IVoiceClient speaker, Vector3 position)
         {
             return NativeLibary.JV_SetRelativePositionForClient(listener.Handle.Identifer, speaker.Handle.Identifer, position.X, position.Y, position.Z);
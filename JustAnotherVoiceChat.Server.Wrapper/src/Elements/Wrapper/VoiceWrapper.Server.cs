@@ -37,7 +37,7 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
     {
         public void CreateNativeServer(VoiceServerConfiguration configuration)
         {
-            NativeLibary.JV_CreateServer(configuration.Port, configuration.TeamspeakServerId, configuration.TeamspeakChannelId, configuration.TeamspeakChannelPassword);
+            NativeLibary.JV_CreateServerWithMaxClients(configuration.Port, configuration.TeamspeakServerId, configuration.TeamspeakChannelId, configuration.TeamspeakChannelPassword, configuration.MaxClients);
         }
 
         public void DestroyNativeServer()
@@ -64,5 +64,75 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Elements.Wrapper
         {
             NativeLibary.JV_SetLogLevel((int) logLevel);
         }
+
+        public void SetWorkerThreadCount(int threadCount)
+        {
+            NativeLibary.JV_SetWorkerThreadCount(threadCount);
+        }
+
+        public void SetPairwiseEvaluation(bool enabled)
+        {
+            NativeLibary.JV_SetPairwiseEvaluation(enabled);
+        }
+
+        public void SetAudibleRangeFactors(float enterFactor, float exitFactor)
+        {
+            NativeLibary.JV_SetAudibleRangeFactors(enterFactor, exitFactor);
+        }
+
+        public void SetTickRate(int tickRate)
+        {
+            NativeLibary.JV_SetTickRate(tickRate);
+        }
+
+        public int GetTickRate()
+        {
+            return NativeLibary.JV_GetTickRate();
+        }
+
+        public ulong GetTickOverrunCount()
+        {
+            return NativeLibary.JV_GetTickOverrunCount();
+        }
+
+        public void SetPositionLevelOfDetail(float nearFactor, int farInterval)
+        {
+            NativeLibary.JV_SetPositionLevelOfDetail(nearFactor, farInterval);
+        }
+
+        public void SetAudibleClientLimit(int limit, bool preferTalking)
+        {
+            NativeLibary.JV_SetAudibleClientLimit(limit, preferTalking);
+        }
+
+        public ulong GetTickDuration()
+        {
+            return NativeLibary.JV_GetTickDuration();
+        }
+
+        public void SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval)
+        {
+            NativeLibary.JV_SetPositionUpdateThreshold(distance, rotation, heartbeatInterval);
+        }
+
+        public ulong GetTickSendLatency()
+        {
+            return NativeLibary.JV_GetTickSendLatency();
+        }
+
+        public void SetNetworkShardCount(int shardCount)
+        {
+            NativeLibary.JV_SetNetworkShardCount(shardCount);
+        }
+
+        public int GetNetworkShardCount()
+        {
+            return NativeLibary.JV_GetNetworkShardCount();
+        }
+
+        public ushort GetClientPort(IVoiceClient client)
+        {
+            return NativeLibary.JV_GetClientPort(client.Handle.Identifer);
+        }
     }
 }
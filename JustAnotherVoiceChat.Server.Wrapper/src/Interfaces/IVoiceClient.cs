@@ -50,6 +50,7 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Interfaces
 
         bool SetNickname(string nickname);
         bool SetVoiceRange(float range);
+        bool SetDimension(int dimension);
         
         bool SetListeningPosition(Vector3 position, float rotation);
         bool SetRelativeSpeakerPosition(IVoiceClient speaker, Vector3 position);
@@ -63,5 +64,6 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Interfaces
 
         ClientPosition MakeClientPosition(Vector3 position, float rotation);
         ClientPosition MakeClientPosition();
+        ClientDimension MakeClientDimension(int dimension);
     }
 }
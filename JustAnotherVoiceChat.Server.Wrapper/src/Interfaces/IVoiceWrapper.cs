@@ -47,6 +47,20 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Interfaces
         
         void Set3DSettings(float distanceFactor, float rolloffFactor);
         void SetLogLevel(LogLevel logLevel);
+        void SetWorkerThreadCount(int threadCount);
+        void SetPairwiseEvaluation(bool enabled);
+        void SetAudibleRangeFactors(float enterFactor, float exitFactor);
+        void SetTickRate(int tickRate);
+        int GetTickRate();
+        ulong GetTickOverrunCount();
+        ulong GetTickDuration();
+        ulong GetTickSendLatency();
+        void SetPositionLevelOfDetail(float nearFactor, int farInterval);
+        void SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval);
+        void SetAudibleClientLimit(int limit, bool preferTalking);
+        void SetNetworkShardCount(int shardCount);
+        int GetNetworkShardCount();
+        ushort GetClientPort(IVoiceClient client);
 
         void UnregisterClientConnectedCallback();
         void UnregisterClientConnectingCallback();
@@ -72,6 +86,8 @@ namespace JustAnotherVoiceChat.Server.Wrapper.Interfaces
         bool SetClientVoiceRange(IVoiceClient client, float voiceRange);
         bool SetListenerPosition(IVoiceClient listener, Vector3 position, float rotation);
         bool SetListenerPositions(IEnumerable<ClientPosition> clientPositions);
+        bool SetClientDimension(IVoiceClient client, int dimension);
+        bool SetClientDimensions(IEnumerable<ClientDimension> clientDimensions);
         bool SetRelativeSpeakerPositionForListener(IVoiceClient listener, IVoiceClient speaker, Vector3 position);
         bool ResetRelativeSpeakerPositionForListener(IVoiceClient listener, IVoiceClient speaker);
         bool ResetAllRelativePositionsForListener(IVoiceClient listener);
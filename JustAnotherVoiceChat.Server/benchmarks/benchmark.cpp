@@ -0,0 +1,236 @@
+/*
+ * File: benchmarks/benchmark.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <stdlib.h>
+#include <enet/enet.h>
+
+#include "justAnotherVoiceChat.h"
+
+#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
+
+// client count is doubled until this limit is reached
+#define BENCHMARK_DEFAULT_MAX_CLIENTS 2000
+#define BENCHMARK_FIRST_CLIENTS 250
+#define BENCHMARK_DURATION 10
+#define BENCHMARK_VOICE_RANGE 20
+#define BENCHMARK_AUDIBLE_CLIENTS 8
+#define BENCHMARK_PI 3.14159265f
+
+typedef struct {
+  int clients;
+  uint64_t averageTickDuration;
+  uint64_t maxTickDuration;
+  uint64_t tickOverruns;
+} benchmarkResult_t;
+
+void sendHandshake(ENetPeer *peer, uint16_t gameId, uint16_t teamspeakId) {
+  handshakePacket_t packet;
+  packet.statusCode = STATUS_CODE_OK;
+  packet.gameId = gameId;
+  packet.teamspeakId = teamspeakId;
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive archive(os);
+    archive(packet);
+  }
+
+  auto data = os.str();
+
+  ENetPacket *enetPacket = enet_packet_create(data.c_str(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  enet_peer_send(peer, NETWORK_HANDSHAKE_CHANNEL, enetPacket);
+}
+
+void serviceClients(ENetHost *host, enet_uint32 timeout) {
+  ENetEvent event;
+
+  while (enet_host_service(host, &event, timeout) > 0) {
+    switch (event.type) {
+      case ENET_EVENT_TYPE_CONNECT:
+        sendHandshake(event.peer, (uint16_t)(size_t)event.peer->data, (uint16_t)(size_t)event.peer->data);
+        break;
+
+      case ENET_EVENT_TYPE_RECEIVE:
+        enet_packet_destroy(event.packet);
+        break;
+
+      default:
+        break;
+    }
+
+    timeout = 0;
+  }
+}
+
+bool connectClients(ENetHost *host, int clients) {
+  ENetAddress address;
+  enet_address_set_host(&address, "localhost");
+  address.port = ENET_PORT;
+
+  for (int i = 0; i < clients; i++) {
+    ENetPeer *peer = enet_host_connect(host, &address, NETWORK_CHANNELS, 0);
+    if (peer == NULL) {
+      return false;
+    }
+
+    // game and teamspeak ids start at 1
+    peer->data = (void *)(size_t)(i + 1);
+  }
+
+  // wait until every client finished the handshake
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+  while (JV_GetNumberOfClients() < clients) {
+    if (std::chrono::steady_clock::now() > timeout) {
+      return false;
+    }
+
+    serviceClients(host, 10);
+  }
+
+  return true;
+}
+
+bool runBenchmark(int clients, benchmarkResult_t &result) {
+  JV_CreateServerWithMaxClients(ENET_PORT, "", 0, "", clients);
+
+  if (JV_StartServer() == false) {
+    std::cerr << "[BENCHMARK] Unable to create JustAnotherVoiceChat server on port " << ENET_PORT << std::endl;
+    JV_DestroyServer();
+    return false;
+  }
+
+  JV_SetWorkerThreadCount((int)std::thread::hardware_concurrency());
+
+  ENetHost *host = enet_host_create(NULL, clients, NETWORK_CHANNELS, 0, 0);
+  if (host == NULL || connectClients(host, clients) == false) {
+    std::cerr << "[BENCHMARK] Unable to connect " << clients << " clients" << std::endl;
+
+    if (host != NULL) {
+      enet_host_destroy(host);
+    }
+
+    JV_StopServer();
+    JV_DestroyServer();
+    return false;
+  }
+
+  // keep the number of audible clients per listener constant while the world grows
+  float side = sqrtf(clients * BENCHMARK_PI * BENCHMARK_VOICE_RANGE * BENCHMARK_VOICE_RANGE / BENCHMARK_AUDIBLE_CLIENTS);
+
+  std::vector<clientPosition_t> positions(clients);
+
+  for (int i = 0; i < clients; i++) {
+    positions[i].gameId = (uint16_t)(i + 1);
+    positions[i].x = side * rand() / RAND_MAX;
+    positions[i].y = side * rand() / RAND_MAX;
+    positions[i].z = 0;
+    positions[i].rotation = 0;
+
+    JV_SetClientVoiceRange(positions[i].gameId, BENCHMARK_VOICE_RANGE);
+  }
+
+  uint64_t firstOverruns = JV_GetTickOverrunCount();
+  uint64_t totalTickDuration = 0;
+  int samples = 0;
+
+  result.clients = clients;
+  result.maxTickDuration = 0;
+
+  auto frameDuration = std::chrono::microseconds(1000000 / JV_GetTickRate());
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(BENCHMARK_DURATION);
+
+  while (std::chrono::steady_clock::now() < end) {
+    auto nextFrame = std::chrono::steady_clock::now() + frameDuration;
+
+    // every client walks a bit every frame
+    for (auto it = positions.begin(); it != positions.end(); it++) {
+      (*it).x += 2.0f * rand() / RAND_MAX - 1.0f;
+      (*it).y += 2.0f * rand() / RAND_MAX - 1.0f;
+      (*it).rotation += 0.1f;
+    }
+
+    JV_SetClientPositions(positions.data(), (int)positions.size());
+
+    serviceClients(host, 0);
+
+    uint64_t tickDuration = JV_GetTickDuration();
+    totalTickDuration += tickDuration;
+    samples++;
+
+    if (tickDuration > result.maxTickDuration) {
+      result.maxTickDuration = tickDuration;
+    }
+
+    std::this_thread::sleep_until(nextFrame);
+  }
+
+  result.averageTickDuration = samples > 0 ? totalTickDuration / samples : 0;
+  result.tickOverruns = JV_GetTickOverrunCount() - firstOverruns;
+
+  enet_host_destroy(host);
+
+  JV_StopServer();
+  JV_DestroyServer();
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int maxClients = BENCHMARK_DEFAULT_MAX_CLIENTS;
+
+  if (argc > 1) {
+    maxClients = atoi(argv[1]);
+  }
+
+  std::vector<benchmarkResult_t> results;
+
+  for (int clients = BENCHMARK_FIRST_CLIENTS; clients <= maxClients; clients *= 2) {
+    benchmarkResult_t result;
+
+    std::cout << "[BENCHMARK] Running with " << clients << " clients..." << std::endl;
+
+    if (runBenchmark(clients, result) == false) {
+      return EXIT_FAILURE;
+    }
+
+    results.push_back(result);
+  }
+
+  std::cout << std::endl << "clients\tavg tick (us)\tmax tick (us)\toverruns" << std::endl;
+
+  for (auto it = results.begin(); it != results.end(); it++) {
+    std::cout << (*it).clients << "\t" << (*it).averageTickDuration << "\t\t" << (*it).maxTickDuration << "\t\t" << (*it).tickOverruns << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/*
+ * File: benchmarks/tickBenchmark.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <stdlib.h>
+#include <enet/enet.h>
+
+#include "client.h"
+#include "clientHandle.h"
+#include "spatialGrid.h"
+#include "positionTable.h"
+#include "packetWriter.h"
+
+// client count is doubled until this limit is reached
+#define TICK_BENCHMARK_DEFAULT_MAX_CLIENTS 2000
+#define TICK_BENCHMARK_FIRST_CLIENTS 250
+#define TICK_BENCHMARK_TICKS 200
+#define TICK_BENCHMARK_VOICE_RANGE 20
+#define TICK_BENCHMARK_AUDIBLE_CLIENTS 8
+#define TICK_BENCHMARK_PI 3.14159265f
+
+using namespace justAnotherVoiceChat;
+
+typedef struct {
+  int clients;
+  uint64_t averageTickDuration;
+  uint64_t maxTickDuration;
+} tickBenchmarkResult_t;
+
+void updateAudibility(const SpatialGrid &grid, const PositionTable &table, size_t index, std::vector<float> &distances) {
+  auto position = table.position(index);
+  auto listener = table.client(index);
+
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  grid.neighbourCellKeys(position, table.dimension(index), cellKeys);
+
+  for (int cell = 0; cell < SPATIAL_GRID_NEIGHBOUR_CELLS; cell++) {
+    size_t begin;
+    size_t end;
+
+    if (table.cellRange(cellKeys[cell], &begin, &end) == false) {
+      continue;
+    }
+
+    if (distances.size() < end - begin) {
+      distances.resize(end - begin);
+    }
+
+    table.squaredDistances(position, begin, end, distances.data());
+
+    for (size_t i = begin; i < end; i++) {
+      if (i == index) {
+        continue;
+      }
+
+      float range = table.voiceRange(i);
+
+      if (distances[i - begin] < range * range) {
+        if (listener->addAudibleClient(table.client(i))) {
+          table.client(i)->addReferencingClient(listener->slot());
+        }
+      } else if (listener->isAudibleClient(table.client(i))) {
+        listener->removeAudibleClient(table.client(i));
+      }
+    }
+  }
+}
+
+void runTickBenchmark(int clients, tickBenchmarkResult_t &result) {
+  // same constant density as the network benchmark
+  float side = sqrtf(clients * TICK_BENCHMARK_PI * TICK_BENCHMARK_VOICE_RANGE * TICK_BENCHMARK_VOICE_RANGE / TICK_BENCHMARK_AUDIBLE_CLIENTS);
+
+  SpatialGrid grid(TICK_BENCHMARK_VOICE_RANGE);
+  PositionTable table;
+  std::vector<std::shared_ptr<Client>> clientList;
+  std::vector<Client *> slotClients;
+  std::vector<float> distances;
+  std::vector<referenceChange_t> referenceChanges;
+
+  for (int i = 0; i < clients; i++) {
+    // clients without a peer never send, only their packets are created
+    auto client = std::make_shared<Client>(nullptr, (uint16_t)(i + 1), (uint16_t)(i + 1));
+    client->setHandle(makeClientHandle((uint32_t)i, 0));
+    client->setVoiceRange(TICK_BENCHMARK_VOICE_RANGE);
+    client->setPosition(linalg::aliases::float3(side * rand() / RAND_MAX, side * rand() / RAND_MAX, 0));
+
+    grid.insertClient(client);
+    clientList.push_back(client);
+    slotClients.push_back(client.get());
+  }
+
+  uint64_t totalTickDuration = 0;
+
+  result.clients = clients;
+  result.maxTickDuration = 0;
+
+  for (uint64_t tick = 1; tick <= TICK_BENCHMARK_TICKS; tick++) {
+    // every client walks a bit every tick, this is not part of the measured work
+    for (auto it = clientList.begin(); it != clientList.end(); it++) {
+      auto position = (*it)->position();
+      position.x += 2.0f * rand() / RAND_MAX - 1.0f;
+      position.y += 2.0f * rand() / RAND_MAX - 1.0f;
+
+      (*it)->setPosition(position);
+      (*it)->setRotation((*it)->rotation() + 0.1f);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto it = clientList.begin(); it != clientList.end(); it++) {
+      grid.updateClient(*it);
+      (*it)->updateMovement(tick, 0, 0);
+    }
+
+    table.build(grid, true);
+
+    for (size_t i = 0; i < table.size(); i++) {
+      updateAudibility(grid, table, i, distances);
+    }
+
+    for (auto it = clientList.begin(); it != clientList.end(); it++) {
+      if ((*it)->buildUpdatePacket(slotClients, referenceChanges)) {
+        enet_packet_destroy(createPacket((*it)->updatePacket(), ENET_PACKET_FLAG_RELIABLE));
+      }
+
+      ENetPacket *positionPacket = (*it)->createPositionPacket(slotClients, tick, 1, 1, 0);
+      if (positionPacket != nullptr) {
+        enet_packet_destroy(positionPacket);
+      }
+    }
+
+    for (auto it = referenceChanges.begin(); it != referenceChanges.end(); it++) {
+      (*it).client->removeReferencingClient((*it).referencingSlot);
+    }
+
+    referenceChanges.clear();
+
+    for (auto it = clientList.begin(); it != clientList.end(); it++) {
+      (*it)->resetPositionChanged();
+    }
+
+    uint64_t tickDuration = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    totalTickDuration += tickDuration;
+
+    if (tickDuration > result.maxTickDuration) {
+      result.maxTickDuration = tickDuration;
+    }
+  }
+
+  result.averageTickDuration = totalTickDuration / TICK_BENCHMARK_TICKS;
+}
+
+int main(int argc, char **argv) {
+  int maxClients = TICK_BENCHMARK_DEFAULT_MAX_CLIENTS;
+
+  if (argc > 1) {
+    maxClients = atoi(argv[1]);
+  }
+
+  // positions are reproducible between runs
+  srand(1);
+
+  std::vector<tickBenchmarkResult_t> results;
+
+  for (int clients = TICK_BENCHMARK_FIRST_CLIENTS; clients <= maxClients; clients *= 2) {
+    tickBenchmarkResult_t result;
+
+    std::cout << "[BENCHMARK] Running tick work with " << clients << " clients..." << std::endl;
+
+    runTickBenchmark(clients, result);
+    results.push_back(result);
+  }
+
+  std::cout << std::endl << "clients\tavg tick (us)\tmax tick (us)" << std::endl;
+
+  for (auto it = results.begin(); it != results.end(); it++) {
+    std::cout << (*it).clients << "\t" << (*it).averageTickDuration << "\t\t" << (*it).maxTickDuration << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -77,6 +77,11 @@ void JUSTANOTHERVOICECHAT_API JV_UnregisterLogMessageCallback();
  */
 void JUSTANOTHERVOICECHAT_API JV_CreateServer(uint16_t port, const char *teamspeakServerId, uint64_t teamspeakChannelId, const char *teamspeakChannelPassword);
 
+/**
+ *
+ */
+void JUSTANOTHERVOICECHAT_API JV_CreateServerWithMaxClients(uint16_t port, const char *teamspeakServerId, uint64_t teamspeakChannelId, const char *teamspeakChannelPassword, int maxClients);
+
 /**
  * 
  */
@@ -178,7 +183,7 @@ int JUSTANOTHERVOICECHAT_API JV_GetNumberOfClients();
 void JUSTANOTHERVOICECHAT_API JV_GetClientGameIds(uint16_t *gameIds, size_t maxLength);
 
 /**
- * 
+ * Applied with the next client update, returns false if a client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_RemoveClient(uint16_t clientId);
 
@@ -188,22 +193,32 @@ bool JUSTANOTHERVOICECHAT_API JV_RemoveClient(uint16_t clientId);
 void JUSTANOTHERVOICECHAT_API JV_RemoveAllClients();
 
 /**
- * 
+ * Applied with the next client update, returns false if a client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_SetClientPosition(uint16_t clientId, float x, float y, float z, float rotation);
 
 /**
- * 
+ * Applied with the next client update, returns false if any client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_SetClientPositions(clientPosition_t *positionUpdates, int length);
 
 /**
- * 
+ * Applied with the next client update, returns false if a client is not connected
+ */
+bool JUSTANOTHERVOICECHAT_API JV_SetClientDimension(uint16_t clientId, int32_t dimension);
+
+/**
+ * Applied with the next client update, returns false if any client is not connected
+ */
+bool JUSTANOTHERVOICECHAT_API JV_SetClientDimensions(clientDimension_t *dimensionUpdates, int length);
+
+/**
+ * Applied with the next client update, returns false if a client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_SetClientVoiceRange(uint16_t clientId, float voiceRange);
 
 /**
- * 
+ * Applied with the next client update, returns false if a client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_SetClientNickname(uint16_t clientId, const char *nickname);
 
@@ -215,21 +230,91 @@ void JUSTANOTHERVOICECHAT_API JV_Set3DSettings(float distanceFactor, float rollo
 /**
  * 
  */
-bool JUSTANOTHERVOICECHAT_API JV_SetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, float x, float y, float z);
+void JUSTANOTHERVOICECHAT_API JV_SetWorkerThreadCount(int threadCount);
 
 /**
  * 
  */
-bool JUSTANOTHERVOICECHAT_API JV_ResetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId);
+void JUSTANOTHERVOICECHAT_API JV_SetPairwiseEvaluation(bool enabled);
 
 /**
  * 
  */
-bool JUSTANOTHERVOICECHAT_API JV_ResetAllRelativePositions(uint16_t clientId);
+void JUSTANOTHERVOICECHAT_API JV_SetAudibleRangeFactors(float enterFactor, float exitFactor);
 
 /**
  * 
  */
+void JUSTANOTHERVOICECHAT_API JV_SetTickRate(int tickRate);
+
+/**
+ * 
+ */
+int JUSTANOTHERVOICECHAT_API JV_GetTickRate();
+
+/**
+ * 
+ */
+uint64_t JUSTANOTHERVOICECHAT_API JV_GetTickOverrunCount();
+
+/**
+ * 
+ */
+uint64_t JUSTANOTHERVOICECHAT_API JV_GetTickDuration();
+
+/**
+ * 
+ */
+uint64_t JUSTANOTHERVOICECHAT_API JV_GetTickSendLatency();
+
+/**
+ * 
+ */
+void JUSTANOTHERVOICECHAT_API JV_SetPositionLevelOfDetail(float nearFactor, int farInterval);
+
+/**
+ * Positions are sent on every change and refreshed every heartbeat interval ticks while clients are audible, the default is 0, 0 and 20
+ */
+void JUSTANOTHERVOICECHAT_API JV_SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval);
+
+/**
+ * 
+ */
+void JUSTANOTHERVOICECHAT_API JV_SetAudibleClientLimit(int limit, bool preferTalking);
+
+/**
+ * 
+ */
+void JUSTANOTHERVOICECHAT_API JV_SetNetworkShardCount(int shardCount);
+
+/**
+ * 
+ */
+int JUSTANOTHERVOICECHAT_API JV_GetNetworkShardCount();
+
+/**
+ * 
+ */
+uint16_t JUSTANOTHERVOICECHAT_API JV_GetClientPort(uint16_t gameId);
+
+/**
+ * Applied with the next client update, returns false if a client is not connected
+ */
+bool JUSTANOTHERVOICECHAT_API JV_SetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, float x, float y, float z);
+
+/**
+ * Applied with the next client update, returns false if a client is not connected
+ */
+bool JUSTANOTHERVOICECHAT_API JV_ResetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId);
+
+/**
+ * Applied with the next client update, returns false if a client is not connected
+ */
+bool JUSTANOTHERVOICECHAT_API JV_ResetAllRelativePositions(uint16_t clientId);
+
+/**
+ * Applied with the next client update, returns false if a client is not connected
+ */
 bool JUSTANOTHERVOICECHAT_API JV_MuteClientForAll(uint16_t clientId, bool muted);
 
 /**
@@ -238,7 +323,7 @@ bool JUSTANOTHERVOICECHAT_API JV_MuteClientForAll(uint16_t clientId, bool muted)
 bool JUSTANOTHERVOICECHAT_API JV_IsClientMutedForAll(uint16_t clientId);
 
 /**
- * 
+ * Applied with the next client update, returns false if a client is not connected
  */
 bool JUSTANOTHERVOICECHAT_API JV_MuteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted);
 
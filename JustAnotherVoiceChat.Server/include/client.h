@@ -28,6 +28,9 @@
 #pragma once
 
 #include "justAnotherVoiceChat.h"
+#include "clientSet.h"
+#include "clientHandle.h"
+#include "positionProtocol.h"
 
 #include <string>
 #include <enet/enet.h>
@@ -36,15 +39,31 @@
 #include <mutex>
 #include <memory>
 
+#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
+
 namespace justAnotherVoiceChat {
   class JUSTANOTHERVOICECHAT_API Client {
   private:
     typedef struct {
-      std::shared_ptr<Client> client;
+      clientHandle_t client;
       linalg::aliases::float3 offset;
     } relativeClient_t;
 
+    typedef struct {
+      clientHandle_t client;
+      int16_t x;
+      int16_t y;
+      int16_t z;
+      uint16_t voiceRange;
+    } quantizedPosition_t;
+
+    typedef struct {
+      uint32_t frame;
+      std::vector<quantizedPosition_t> positions;
+    } positionKeyframe_t;
+
     ENetPeer *_peer;
+    clientHandle_t _handle;
     uint16_t _gameId;
     uint16_t _teamspeakId;
 
@@ -52,77 +71,133 @@ namespace justAnotherVoiceChat {
     float _rotation;
     bool _positionChanged;
     float _voiceRange;
-    std::vector<std::shared_ptr<Client>> _audibleClients;
-    std::vector<std::shared_ptr<Client>> _addAudibleClients;
-    std::vector<std::shared_ptr<Client>> _removeAudibleClients;
-
+    int32_t _dimension;
+    linalg::aliases::float3 _movedPosition;
+    float _movedRotation;
+    float _movedVoiceRange;
+    int32_t _movedDimension;
+    uint64_t _movedTick;
+
+    // client sets are guarded by the clients mutex of the server, parallel updates only write the sets of their own listeners
+    ClientSet _audibleClients;
+    ClientSet _unmutedClients;
+    ClientSet _nextUnmutedClients;
+    ClientSet _newAudibleClients;
+    bool _audibleClientsChanged;
+    bool _hasNewAudibleClients;
+
+    ClientSet _relativeClients;
     std::vector<relativeClient_t> _relativeAudibleClients;
     std::vector<relativeClient_t> _addRelativeAudibleClients;
-    std::vector<std::shared_ptr<Client>> _removeRelativeAudibleClients;
+
+    updatePacket_t _updatePacket;
+    positionPacket_t _positionPacket;
+
+    bool _positionPending;
+    uint64_t _positionSentTick;
+    std::vector<uint64_t> _speakerSentTicks;
+
+    bool _quantizedPositions;
+    uint32_t _positionFrame;
+    uint32_t _positionKeyframeFrame;
+    positionKeyframe_t _positionKeyframes[POSITION_KEYFRAME_HISTORY];
+    size_t _nextPositionKeyframe;
+    int _positionBaseKeyframe;
+    quantizedPositionPacket_t _quantizedPositionPacket;
 
     bool _talking;
     bool _microphoneMuted;
     bool _speakersMuted;
     std::string _nickname;
+    bool _controlMessagePending;
 
     bool _muted;
-    std::vector<std::shared_ptr<Client>> _mutedClients;
+    ClientSet _mutedClients;
+
+    ClientSet _referencingClients;
 
-    std::mutex _audibleClientsMutex;
-    std::mutex _mutedClientsMutex;
     std::mutex _peerMutex;
 
   public:
     Client(ENetPeer *peer, uint16_t gameId, uint16_t teamspeakId);
     virtual ~Client();
 
+    void setHandle(clientHandle_t handle);
+    clientHandle_t handle() const;
+    uint32_t slot() const;
     uint16_t gameId() const;
     uint16_t teamspeakId() const;
 
     void disconnect();
     bool isConnected() const;
 
-    void cleanupKnownClient(std::shared_ptr<Client> client);
+    void cleanupKnownClient(Client *client);
+    void addReferencingClient(uint32_t slot);
+    void removeReferencingClient(uint32_t slot);
+    std::vector<Client *> referencingClients(const std::vector<Client *> &slotClients);
+    std::vector<Client *> referencedClients(const std::vector<Client *> &slotClients);
 
     bool isTalking() const;
     bool hasMicrophoneMuted() const;
     bool hasSpeakersMuted() const;
     std::string endpoint();
     bool isPeer(ENetPeer *peer);
+    ENetPeer *peer();
+    ENetHost *host();
 
     void setMuted(bool muted);
     bool isMuted() const;
-    void setMutedClient(std::shared_ptr<Client> client, bool muted);
-    bool isMutedClient(std::shared_ptr<Client> client);
+    void setMutedClient(Client *client, bool muted);
+    bool isMutedClient(Client *client);
+    std::vector<Client *> mutedClients(const std::vector<Client *> &slotClients);
 
     bool handleHandshake(ENetPacket *packet);
     bool handleStatus(ENetPacket *packet, bool *talkingChanged, bool *microphoneChanged, bool *speakersChanged);
+    bool handlePositionAck(ENetPacket *packet);
 
-    void addAudibleClient(std::shared_ptr<Client> client);
-    void removeAudibleClient(std::shared_ptr<Client> client);
-    void addRelativeAudibleClient(std::shared_ptr<Client> client, linalg::aliases::float3 position);
-    void removeRelativeAudibleClient(std::shared_ptr<Client> client);
+    bool addAudibleClient(Client *client);
+    void removeAudibleClient(Client *client);
+    void addRelativeAudibleClient(Client *client, linalg::aliases::float3 position);
+    void removeRelativeAudibleClient(Client *client);
     void removeAllRelativeAudibleClients();
+    bool isAudibleClient(Client *client);
+    std::vector<Client *> audibleClients(const std::vector<Client *> &slotClients);
+
+    bool buildUpdatePacket(const std::vector<Client *> &slotClients, std::vector<referenceChange_t> &referenceChanges);
+    const updatePacket_t &updatePacket() const;
+    ENetPacket *createPositionPacket(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval, int heartbeatInterval);
+    void sendPacket(ENetPacket *packet, int channel);
+    bool queuePacket(ENetPacket *packet, int channel);
 
-    void sendUpdate();
-    void sendPositions();
+    void setQuantizedPositions(bool enabled);
+    bool quantizedPositions() const;
 
     void setPosition(linalg::aliases::float3 position);
     linalg::aliases::float3 position() const;
     void setRotation(float rotation);
     float rotation() const;
+    void setPositionChanged();
     void resetPositionChanged();
     bool positionChanged() const;
+    void updateMovement(uint64_t tick, float distanceThreshold, float rotationThreshold);
+    uint64_t movedTick() const;
     void setVoiceRange(float range);
     float voiceRange() const;
+    void setDimension(int32_t dimension);
+    int32_t dimension() const;
 
     void setNickname(std::string nickname);
     std::string nickname() const;
+    ENetPacket *createControlPacket();
 
   private:
-    void sendControlMessage();
-    void sendPacket(void *data, size_t length, int channel, bool reliable = true);
+    ENetPacket *createQuantizedPositionPacket(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval);
+    bool positionPacketDue(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval, int heartbeatInterval);
+    bool isSkippedFarClient(Client *client, uint32_t slot, uint64_t tick, float nearFactor, int farInterval);
+    bool speakerPosition(const std::vector<Client *> &slotClients, uint32_t slot, uint64_t tick, float nearFactor, int farInterval, clientPositionUpdate_t *positionUpdate);
   
-    bool isRelativeClient(std::shared_ptr<Client> client) const;
+    static Client *clientByHandle(const std::vector<Client *> &slotClients, clientHandle_t handle);
+    bool isRelativeClient(Client *client) const;
+    void removeRelativeOffsets(Client *client);
   };
 }
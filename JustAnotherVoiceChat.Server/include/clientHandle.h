@@ -0,0 +1,61 @@
+/*
+ * File: include/clientHandle.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+// handles combine the slot of a client with a generation counting the reuses of that slot
+#define CLIENT_HANDLE_SLOT_BITS 16
+#define CLIENT_HANDLE_SLOT_MASK 0xFFFF
+#define CLIENT_HANDLE_INVALID 0xFFFFFFFF
+
+namespace justAnotherVoiceChat {
+  class Client;
+
+  typedef uint32_t clientHandle_t;
+
+  // referencing sets of other clients are changed after the parallel phases of an update
+  typedef struct {
+    Client *client;
+    uint32_t referencingSlot;
+    bool referenced;
+  } referenceChange_t;
+
+  inline clientHandle_t makeClientHandle(uint32_t slot, uint16_t generation) {
+    return ((clientHandle_t)generation << CLIENT_HANDLE_SLOT_BITS) | (slot & CLIENT_HANDLE_SLOT_MASK);
+  }
+
+  inline uint32_t clientHandleSlot(clientHandle_t handle) {
+    return handle & CLIENT_HANDLE_SLOT_MASK;
+  }
+
+  inline uint16_t clientHandleGeneration(clientHandle_t handle) {
+    return (uint16_t)(handle >> CLIENT_HANDLE_SLOT_BITS);
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ * File: include/clientSet.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace justAnotherVoiceChat {
+  class ClientSet {
+  private:
+    std::vector<uint64_t> _words;
+
+  public:
+    ClientSet();
+    virtual ~ClientSet();
+
+    void set(uint32_t slot);
+    void reset(uint32_t slot);
+    bool test(uint32_t slot) const;
+    void clear();
+    bool empty() const;
+
+    void assignUnion(const ClientSet &set, const ClientSet &otherSet);
+    void assignDifference(const ClientSet &set, const ClientSet &otherSet);
+    void swap(ClientSet &set);
+
+    template<typename Function>
+    void forEach(Function function) const {
+      for (size_t i = 0; i < _words.size(); i++) {
+        forEachBit(_words[i], i, function);
+      }
+    }
+
+    // calls function for every slot which is only in one of both sets
+    template<typename Function>
+    void forEachChanged(const ClientSet &set, Function function) const {
+      size_t size = _words.size() > set._words.size() ? _words.size() : set._words.size();
+
+      for (size_t i = 0; i < size; i++) {
+        forEachBit(word(i) ^ set.word(i), i, function);
+      }
+    }
+
+  private:
+    uint64_t word(size_t index) const;
+
+    template<typename Function>
+    static void forEachBit(uint64_t word, size_t index, Function function) {
+      while (word != 0) {
+        function((uint32_t)(index * 64 + trailingZeros(word)));
+
+        // clear lowest set bit
+        word &= word - 1;
+      }
+    }
+
+    static unsigned int trailingZeros(uint64_t word) {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward64(&index, word);
+      return (unsigned int)index;
+#else
+      return (unsigned int)__builtin_ctzll(word);
+#endif
+    }
+  };
+}
@@ -0,0 +1,91 @@
+/*
+ * File: include/commandQueue.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace justAnotherVoiceChat {
+  // unbounded multi producer, single consumer queue
+  template<typename Command>
+  class CommandQueue {
+  private:
+    typedef struct commandNode {
+      Command command;
+      std::atomic<struct commandNode *> next;
+    } commandNode_t;
+
+    std::atomic<commandNode_t *> _head;
+    commandNode_t *_tail;
+
+  public:
+    CommandQueue() {
+      // the tail always points to an already consumed node
+      commandNode_t *stub = new commandNode_t();
+      stub->next.store(nullptr, std::memory_order_relaxed);
+
+      _head.store(stub, std::memory_order_relaxed);
+      _tail = stub;
+    }
+
+    virtual ~CommandQueue() {
+      Command command;
+      while (pop(command)) {
+      }
+
+      delete _tail;
+    }
+
+    // may be called from any thread, never waits for the consumer
+    void push(Command &command) {
+      commandNode_t *node = new commandNode_t();
+      node->command = std::move(command);
+      node->next.store(nullptr, std::memory_order_relaxed);
+
+      // producers only race on the head exchange
+      commandNode_t *previous = _head.exchange(node, std::memory_order_acq_rel);
+      previous->next.store(node, std::memory_order_release);
+    }
+
+    // may only be called from the consuming thread
+    bool pop(Command &command) {
+      // a producer between exchange and link hides its command until the next pop
+      commandNode_t *next = _tail->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return false;
+      }
+
+      command = std::move(next->command);
+
+      delete _tail;
+      _tail = next;
+      return true;
+    }
+  };
+}
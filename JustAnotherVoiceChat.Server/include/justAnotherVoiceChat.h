@@ -48,6 +48,11 @@ typedef struct {
   uint16_t gameId;
 } clientPosition_t;
 
+typedef struct {
+  int32_t dimension;
+  uint16_t gameId;
+} clientDimension_t;
+
 // C++ public classes
 #include "server.h"
 #include "client.h"
@@ -0,0 +1,82 @@
+/*
+ * File: include/packetReader.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <enet/enet.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "positionProtocol.h"
+
+#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
+
+namespace justAnotherVoiceChat {
+  // reads the layout of cereal's binary archive directly from a received buffer
+  class PacketReader {
+  private:
+    const uint8_t *_data;
+    size_t _length;
+    size_t _offset;
+    bool _failed;
+
+  public:
+    PacketReader(const uint8_t *data, size_t length);
+    virtual ~PacketReader();
+
+    bool readBool(bool *value);
+    bool readUint16(uint16_t *value);
+    bool readInt(int *value);
+    bool readUint32(uint32_t *value);
+    bool readSize(size_t *size);
+    bool readString(std::string *value);
+
+    size_t remaining() const;
+    bool failed() const;
+
+  private:
+    bool read(void *data, size_t length);
+  };
+
+  bool readPacket(PacketReader &reader, protocolPacket_t *packet);
+  bool readPacket(PacketReader &reader, handshakePacket_t *packet);
+  bool readPacket(PacketReader &reader, statusPacket_t *packet);
+  bool readPacket(PacketReader &reader, positionAckPacket_t *packet);
+
+  // parses the data of a received enet packet in place, fails on truncated or oversized fields
+  template<typename Packet>
+  bool parsePacket(const ENetPacket *packet, Packet *result) {
+    if (packet == nullptr || packet->data == nullptr) {
+      return false;
+    }
+
+    PacketReader reader(packet->data, packet->dataLength);
+    return readPacket(reader, result) && reader.failed() == false;
+  }
+}
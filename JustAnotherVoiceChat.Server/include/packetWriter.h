@@ -0,0 +1,114 @@
+/*
+ * File: include/packetWriter.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <enet/enet.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "log.h"
+#include "positionProtocol.h"
+
+#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
+
+namespace justAnotherVoiceChat {
+  // writes the layout of cereal's binary archive directly into a buffer of fixed length
+  class PacketWriter {
+  private:
+    uint8_t *_data;
+    size_t _length;
+    size_t _offset;
+    bool _overflow;
+
+  public:
+    PacketWriter(uint8_t *data, size_t length);
+    virtual ~PacketWriter();
+
+    void writeBool(bool value);
+    void writeInt8(int8_t value);
+    void writeUint8(uint8_t value);
+    void writeInt16(int16_t value);
+    void writeUint16(uint16_t value);
+    void writeInt(int value);
+    void writeUint32(uint32_t value);
+    void writeUint64(uint64_t value);
+    void writeFloat(float value);
+    void writeSize(size_t size);
+    void writeString(const std::string &value);
+
+    size_t offset() const;
+    bool overflowed() const;
+
+  private:
+    void write(const void *data, size_t length);
+  };
+
+  size_t packetSize(const protocolResponsePacket_t &packet);
+  size_t packetSize(const handshakeResponsePacket_t &packet);
+  size_t packetSize(const controlPacket_t &packet);
+  size_t packetSize(const updatePacket_t &packet);
+  size_t packetSize(const positionPacket_t &packet);
+  size_t packetSize(const quantizedPositionPacket_t &packet);
+
+  void writePacket(PacketWriter &writer, const protocolResponsePacket_t &packet);
+  void writePacket(PacketWriter &writer, const handshakeResponsePacket_t &packet);
+  void writePacket(PacketWriter &writer, const controlPacket_t &packet);
+  void writePacket(PacketWriter &writer, const updatePacket_t &packet);
+  void writePacket(PacketWriter &writer, const positionPacket_t &packet);
+  void writePacket(PacketWriter &writer, const quantizedPositionPacket_t &packet);
+
+  // lets identical payloads of different recipients be serialized once
+  uint64_t packetHash(const updatePacket_t &packet);
+  bool isSamePacket(const updatePacket_t &packet, const updatePacket_t &otherPacket);
+
+  // serializes into the data of a new enet packet, which is the only allocation and copy
+  template<typename Packet>
+  ENetPacket *createPacket(const Packet &packet, enet_uint32 flags) {
+    size_t length = packetSize(packet);
+
+    ENetPacket *enetPacket = enet_packet_create(nullptr, length, flags);
+    if (enetPacket == nullptr) {
+      logMessage("Unable to allocate packet of " + std::to_string(length) + " bytes", LOG_LEVEL_ERROR);
+      return nullptr;
+    }
+
+    PacketWriter writer(enetPacket->data, enetPacket->dataLength);
+    writePacket(writer, packet);
+
+    if (writer.overflowed() || writer.offset() != length) {
+      logMessage("Serialized packet does not match its size of " + std::to_string(length) + " bytes", LOG_LEVEL_ERROR);
+
+      enet_packet_destroy(enetPacket);
+      return nullptr;
+    }
+
+    return enetPacket;
+  }
+}
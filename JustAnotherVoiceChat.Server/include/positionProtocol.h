@@ -0,0 +1,101 @@
+/*
+ * File: include/positionProtocol.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// protocol revision which replaces positionPacket_t with quantized delta frames
+#define PROTOCOL_QUANTIZED_POSITIONS_VERSION_MAJOR 0
+#define PROTOCOL_QUANTIZED_POSITIONS_VERSION_MINOR 4
+
+// coordinates are fixed point with 8 fractional bits, voice ranges with 4
+#define POSITION_COORDINATE_SCALE 256.0f
+#define POSITION_VOICE_RANGE_SCALE 16.0f
+
+// a keyframe is sent every interval, deltas refer to the last acknowledged one
+#define POSITION_KEYFRAME_INTERVAL 20
+#define POSITION_KEYFRAME_HISTORY 4
+
+// entries carry absolute values instead of 8 bit deltas
+#define POSITION_UPDATE_FLAG_FULL 1
+
+namespace justAnotherVoiceChat {
+  typedef struct {
+    uint16_t teamspeakId;
+    uint8_t flags;
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    uint16_t voiceRange;
+  } quantizedPositionUpdate_t;
+
+  // keyframes have their own frame as base frame
+  typedef struct {
+    uint32_t frame;
+    uint32_t baseFrame;
+    float x;
+    float y;
+    float z;
+    float rotation;
+    std::vector<quantizedPositionUpdate_t> positions;
+  } quantizedPositionPacket_t;
+
+  // sent by the client on the position channel for every received keyframe
+  typedef struct {
+    uint32_t frame;
+  } positionAckPacket_t;
+
+  inline int16_t quantizeCoordinate(float value) {
+    float scaled = value * POSITION_COORDINATE_SCALE;
+
+    // zero voice ranges produce invalid values
+    if (scaled != scaled) {
+      return 0;
+    } else if (scaled >= INT16_MAX) {
+      return INT16_MAX;
+    } else if (scaled <= INT16_MIN) {
+      return INT16_MIN;
+    }
+
+    return (int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+  }
+
+  inline uint16_t quantizeVoiceRange(float value) {
+    float scaled = value * POSITION_VOICE_RANGE_SCALE;
+
+    if (scaled >= UINT16_MAX) {
+      return UINT16_MAX;
+    } else if (scaled <= 0 || scaled != scaled) {
+      return 0;
+    }
+
+    return (uint16_t)(scaled + 0.5f);
+  }
+}
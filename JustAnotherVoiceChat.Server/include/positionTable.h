@@ -0,0 +1,86 @@
+/*
+ * File: include/positionTable.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <linalg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+#define POSITION_FLAG_CHANGED 1
+#define POSITION_FLAG_MUTED 2
+#define POSITION_FLAG_UPDATE 4
+
+namespace justAnotherVoiceChat {
+  class Client;
+  class SpatialGrid;
+
+  class PositionTable {
+  private:
+    typedef struct {
+      size_t begin;
+      size_t end;
+      bool changed;
+    } cellRange_t;
+
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _z;
+    std::vector<float> _range;
+    std::vector<int32_t> _dimension;
+    std::vector<uint8_t> _flags;
+    std::vector<Client *> _clients;
+    std::unordered_map<uint64_t, cellRange_t> _cellRanges;
+    std::vector<uint64_t> _cellKeys;
+
+  public:
+    PositionTable();
+    virtual ~PositionTable();
+
+    void build(const SpatialGrid &grid, bool allChanged = false);
+    void clear();
+    size_t size() const;
+
+    size_t cellCount() const;
+    uint64_t cellKey(size_t index) const;
+    bool cellRange(uint64_t cellKey, size_t *begin, size_t *end) const;
+    bool cellChanged(uint64_t cellKey) const;
+
+    Client *client(size_t index) const;
+    linalg::aliases::float3 position(size_t index) const;
+    float voiceRange(size_t index) const;
+    int32_t dimension(size_t index) const;
+    uint8_t flags(size_t index) const;
+    void addFlags(size_t begin, size_t end, uint8_t flags);
+
+    void squaredDistances(linalg::aliases::float3 position, size_t begin, size_t end, float *distances) const;
+  };
+}
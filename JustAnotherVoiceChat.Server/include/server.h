@@ -28,6 +28,13 @@
 #pragma once
 
 #include "justAnotherVoiceChat.h"
+#include "spatialGrid.h"
+#include "positionTable.h"
+#include "workerPool.h"
+#include "commandQueue.h"
+#include "snapshotBuffer.h"
+#include "clientSet.h"
+#include "clientHandle.h"
 
 #include <enet/enet.h>
 #include <stdint.h>
@@ -37,6 +44,19 @@
 #include <string>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+#include <atomic>
+
+#define SERVER_DEFAULT_MAX_CLIENTS 256
+
+// longest wait of the network thread, enet has to check its timers regularly
+#define SERVER_NETWORK_TIMEOUT 10
+
+// upper limit of hosts listening on consecutive ports
+#define SERVER_MAX_NETWORK_SHARDS 16
+
+// positions beyond are rejected, the grid and the quantization can't place them
+#define SERVER_MAX_POSITION_COORDINATE 1e9f
 
 namespace justAnotherVoiceChat {
   typedef void (* ClientCallback_t)(uint16_t);
@@ -48,14 +68,147 @@ namespace justAnotherVoiceChat {
 
   class JUSTANOTHERVOICECHAT_API Server {
   private:
+    typedef struct {
+      // removed clients only leave their previous position behind
+      Client *client;
+      linalg::aliases::float3 previousPosition;
+      int32_t previousDimension;
+    } dirtyClient_t;
+
+    typedef struct {
+      bool hasUpdate;
+      bool ownsUpdatePacket;
+      ENetPacket *updatePacket;
+      ENetPacket *positionPacket;
+      ENetPacket *controlPacket;
+    } clientPackets_t;
+
+    typedef struct {
+      uint64_t hash;
+      size_t index;
+      ENetHost *host;
+    } updateRecipient_t;
+
+    typedef struct {
+      size_t index;
+      float distance;
+      bool talking;
+    } audibleCandidate_t;
+
+    typedef struct {
+      size_t listener;
+      size_t speaker;
+      float squaredDistance;
+    } audibilityPair_t;
+
+    typedef enum {
+      COMMAND_REMOVE_CLIENT,
+      COMMAND_REMOVE_ALL_CLIENTS,
+      COMMAND_SET_CLIENT_POSITION,
+      COMMAND_SET_CLIENT_POSITIONS,
+      COMMAND_SET_CLIENT_DIMENSION,
+      COMMAND_SET_CLIENT_DIMENSIONS,
+      COMMAND_SET_CLIENT_VOICE_RANGE,
+      COMMAND_SET_CLIENT_NICKNAME,
+      COMMAND_SET_RELATIVE_POSITION,
+      COMMAND_RESET_RELATIVE_POSITION,
+      COMMAND_RESET_ALL_RELATIVE_POSITIONS,
+      COMMAND_MUTE_CLIENT_FOR_ALL,
+      COMMAND_MUTE_CLIENT_FOR_CLIENT
+    } commandType_t;
+
+    typedef struct {
+      commandType_t type;
+      uint16_t gameId;
+      uint16_t otherGameId;
+      linalg::aliases::float3 position;
+      float value;
+      int32_t dimension;
+      bool flag;
+      std::string text;
+      std::vector<clientPosition_t> positions;
+      std::vector<clientDimension_t> dimensions;
+    } command_t;
+
+    typedef struct {
+      ENetAddress address;
+      ENetHost *host;
+      ENetSocket wakeupSocket;
+      ENetAddress wakeupAddress;
+      std::mutex mutex;
+      std::shared_ptr<std::thread> thread;
+      std::vector<ENetEvent> events;
+      std::vector<bool> peerQuantizedPositions;
+      std::vector<bool> peerReserved;
+    } networkShard_t;
+
+    typedef struct {
+      int numberOfClients;
+      ClientSet connectedClients;
+      ClientSet mutedClients;
+      std::vector<uint32_t> mutedClientPairs;
+    } clientSnapshot_t;
+
     ENetAddress _address;
-    ENetHost *_server;
+    std::vector<std::shared_ptr<networkShard_t>> _shards;
+    int _shardCount;
 
-    std::shared_ptr<std::thread> _thread;
     std::shared_ptr<std::thread> _clientUpdateThread;
     std::vector<std::shared_ptr<Client>> _clients;
+    std::unordered_map<uint16_t, std::shared_ptr<Client>> _gameIdClients;
+    std::unordered_map<uint16_t, std::shared_ptr<Client>> _teamspeakIdClients;
+    std::vector<Client *> _slotClients;
+    std::vector<uint16_t> _slotGenerations;
+    std::vector<uint32_t> _freeSlots;
     std::mutex _clientsMutex;
     std::mutex _serverMutex;
+    CommandQueue<command_t> _commands;
+    SnapshotBuffer<clientSnapshot_t> _snapshots;
+    SpatialGrid _spatialGrid;
+    PositionTable _positionTable;
+    std::vector<dirtyClient_t> _dirtyClients;
+    std::vector<size_t> _updateListeners;
+    std::vector<clientPackets_t> _clientPackets;
+    std::vector<updateRecipient_t> _updateRecipients;
+    WorkerPool _workerPool;
+    std::vector<std::vector<float>> _workerDistances;
+    std::vector<std::vector<audibleCandidate_t>> _workerCandidates;
+    std::vector<std::vector<audibilityPair_t>> _workerPairs;
+    std::vector<std::vector<referenceChange_t>> _workerReferenceChanges;
+    bool _fullUpdate;
+    bool _pairwiseEvaluation;
+    float _audibleEnterFactor;
+    float _audibleExitFactor;
+    int _maxClients;
+    std::atomic<int> _reservedPeers;
+    int _tickRate;
+    std::atomic<uint64_t> _tickOverruns;
+    std::atomic<uint64_t> _tickDuration;
+    std::atomic<uint64_t> _tickSendLatency;
+    uint64_t _tick;
+    float _positionNearFactor;
+    int _positionFarInterval;
+    float _positionDistanceThreshold;
+    float _positionRotationThreshold;
+    int _positionHeartbeatInterval;
+    int _audibleClientLimit;
+    bool _audibleClientLimitTalking;
+
+    // settings of the api, taken over by the update thread at the start of a tick
+    std::atomic<int> _nextWorkerThreadCount;
+    std::atomic<bool> _nextPairwiseEvaluation;
+    std::atomic<float> _nextAudibleEnterFactor;
+    std::atomic<float> _nextAudibleExitFactor;
+    std::atomic<int> _nextTickRate;
+    std::atomic<float> _nextPositionNearFactor;
+    std::atomic<int> _nextPositionFarInterval;
+    std::atomic<float> _nextPositionDistanceThreshold;
+    std::atomic<float> _nextPositionRotationThreshold;
+    std::atomic<int> _nextPositionHeartbeatInterval;
+    std::atomic<int> _nextAudibleClientLimit;
+    std::atomic<bool> _nextAudibleClientLimitTalking;
+    std::atomic<uint64_t> _settingsVersion;
+    uint64_t _appliedSettingsVersion;
 
     ClientConnectingCallback_t _clientConnectingCallback;
     ClientCallback_t _clientConnectedCallback;
@@ -73,7 +226,7 @@ namespace justAnotherVoiceChat {
     std::string _teamspeakChannelPassword;
 
   public:
-    Server(uint16_t port, std::string teamspeakServerId, uint64_t teamspeakChannelId, std::string teamspeakChannelPassword);
+    Server(uint16_t port, std::string teamspeakServerId, uint64_t teamspeakChannelId, std::string teamspeakChannelPassword, int maxClients = SERVER_DEFAULT_MAX_CLIENTS);
     virtual ~Server();
 
     bool create();
@@ -85,6 +238,9 @@ namespace justAnotherVoiceChat {
     std::string teamspeakChannelPassword() const;
 
     uint16_t port() const;
+    void setNetworkShardCount(int shardCount);
+    int networkShardCount();
+    uint16_t clientPort(uint16_t gameId);
     int maxClients() const;
     int numberOfClients() const;
     bool removeClient(uint16_t gameId);
@@ -94,6 +250,8 @@ namespace justAnotherVoiceChat {
     bool setClientVoiceRange(uint16_t gameId, float voiceRange);
     bool setClientPosition(uint16_t gameId, linalg::aliases::float3 position, float rotation);
     bool setClientPositions(clientPosition_t *positionUpdates, int length);
+    bool setClientDimension(uint16_t gameId, int32_t dimension);
+    bool setClientDimensions(clientDimension_t *dimensionUpdates, int length);
     bool setClientNickname(uint16_t gameId, std::string nickname);
     bool setRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, linalg::aliases::float3 position);
     bool resetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId);
@@ -101,6 +259,24 @@ namespace justAnotherVoiceChat {
 
     void set3DSettings(float distanceFactor, float rolloffFactor);
 
+    void setWorkerThreadCount(int threadCount);
+    int workerThreadCount() const;
+
+    void setPairwiseEvaluation(bool enabled);
+    bool pairwiseEvaluation() const;
+
+    void setAudibleRangeFactors(float enterFactor, float exitFactor);
+
+    void setTickRate(int tickRate);
+    int tickRate();
+    uint64_t tickOverruns();
+    uint64_t tickDuration();
+    uint64_t tickSendLatency();
+
+    void setPositionLevelOfDetail(float nearFactor, int farInterval);
+    void setPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval);
+    void setAudibleClientLimit(int limit, bool preferTalking);
+
     bool muteClientForAll(uint16_t gameId, bool muted);
     bool isClientMutedForAll(uint16_t gameId);
     bool muteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted);
@@ -115,13 +291,65 @@ namespace justAnotherVoiceChat {
     void registerClientMicrophoneMuteChangedCallback(ClientStatusCallback_t callback);
 
   private:
-    void update();
+    void update(networkShard_t *shard);
+    void waitForNetwork(networkShard_t *shard, ENetSocket socket, enet_uint32 timeout);
+    bool createWakeupSocket(networkShard_t *shard);
+    void destroyWakeupSocket(networkShard_t *shard);
+    void wakeNetwork(networkShard_t *shard);
+    void destroyShards();
     void updateClients();
+    void applySettings();
+    void pushCommand(command_t &command);
+    void applyCommands();
+    void applyCommand(command_t &command);
+    bool applyRemoveClient(uint16_t gameId);
+    bool applyRemoveAllClients();
+    bool applyClientPosition(uint16_t gameId, linalg::aliases::float3 position, float rotation);
+    bool applyClientPositions(const clientPosition_t *positionUpdates, int length);
+    bool applyClientDimension(uint16_t gameId, int32_t dimension);
+    bool applyClientDimensions(const clientDimension_t *dimensionUpdates, int length);
+    bool applyClientVoiceRange(uint16_t gameId, float voiceRange);
+    bool applyClientNickname(uint16_t gameId, std::string nickname);
+    bool applyRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, linalg::aliases::float3 position);
+    bool applyResetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId);
+    bool applyResetAllRelativePositions(uint16_t gameId);
+    bool applyMuteClientForAll(uint16_t gameId, bool muted);
+    bool applyMuteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted);
+    void updateAudibleClients();
+    void updateListener(size_t index, std::vector<float> &distances, std::vector<referenceChange_t> &referenceChanges);
+    void updateLimitedListener(size_t index, std::vector<float> &distances, std::vector<audibleCandidate_t> &candidates, std::vector<referenceChange_t> &referenceChanges);
+    void updateCellPairs(uint64_t cellKey, std::vector<float> &distances, std::vector<audibilityPair_t> &pairs, std::vector<referenceChange_t> &referenceChanges);
+    void updateAudibility(size_t listener, size_t speaker, float squaredDistance, std::vector<referenceChange_t> &referenceChanges);
+    void addAudibleClient(Client *listener, Client *speaker, std::vector<referenceChange_t> &referenceChanges);
+    void applyReferenceChanges();
+    void removeDistantAudibleClients(size_t index);
+    void markNeighbourCells(linalg::aliases::float3 position, int32_t dimension);
+    void createClientPackets(size_t index, std::vector<referenceChange_t> &referenceChanges);
+    void createUpdatePackets();
+    void sendClientPackets();
+    void publishSnapshot();
     void abortThreads();
+    void updateSpatialGridCellSize();
+    void addDirtyClient(Client *client, linalg::aliases::float3 previousPosition, int32_t previousDimension);
+    void updateClientDimension(const std::shared_ptr<Client> &client, int32_t dimension);
+    void setClientChanged(Client *client);
+    void removeDirtyClient(Client *client);
+    void disconnectClient(std::shared_ptr<Client> client);
 
-    std::shared_ptr<Client> clientByGameId(uint16_t gameId) const;
+    const std::shared_ptr<Client> &clientByGameId(uint16_t gameId) const;
     std::shared_ptr<Client> clientByTeamspeakId(uint16_t teamspeakId) const;
     std::shared_ptr<Client> clientByPeer(ENetPeer *peer) const;
+    networkShard_t *shardByPeer(ENetPeer *peer) const;
+    networkShard_t *shardByHost(ENetHost *host) const;
+    size_t peerIndex(ENetPeer *peer) const;
+    bool reservePeer(networkShard_t *shard, size_t index);
+    void releasePeer(networkShard_t *shard, size_t index);
+    void cleanupClientReferences(std::shared_ptr<Client> client);
+    void addClientLookup(std::shared_ptr<Client> client);
+    void addIdLookup(std::shared_ptr<Client> client);
+    bool isGameIdConnected(uint16_t gameId) const;
+    static bool isValidPosition(linalg::aliases::float3 position, float rotation);
+    void removeClientLookup(std::shared_ptr<Client> client);
 
     void onClientConnect(ENetEvent &event);
     void onClientDisconnect(ENetEvent &event);
@@ -130,6 +358,9 @@ namespace justAnotherVoiceChat {
     void handleProtocolMessage(ENetEvent &event);
     void handleHandshake(ENetEvent &event);
     void sendHandshakeResponse(ENetPeer *peer, int statusCode, std::string reason);
-    void sendProtocolResponse(ENetPeer *peer, int statusCode);
+    void sendProtocolResponse(ENetPeer *peer, int statusCode, uint16_t versionMajor, uint16_t versionMinor);
+    void sendPeerPacket(ENetPeer *peer, ENetPacket *packet, int channel);
+    void disconnectPeer(ENetPeer *peer, enet_uint32 data);
+    void disconnectPeerLater(ENetPeer *peer, enet_uint32 data);
   };
 }
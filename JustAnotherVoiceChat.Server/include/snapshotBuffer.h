@@ -0,0 +1,93 @@
+/*
+ * File: include/snapshotBuffer.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+
+#define SNAPSHOT_BUFFER_COUNT 3
+
+namespace justAnotherVoiceChat {
+  // snapshots written by a single thread and read by any number of threads
+  template<typename Snapshot>
+  class SnapshotBuffer {
+  private:
+    Snapshot _snapshots[SNAPSHOT_BUFFER_COUNT];
+    mutable std::atomic<int> _readers[SNAPSHOT_BUFFER_COUNT];
+    std::atomic<int> _current;
+
+  public:
+    SnapshotBuffer() {
+      for (int i = 0; i < SNAPSHOT_BUFFER_COUNT; i++) {
+        _readers[i].store(0);
+      }
+
+      _current.store(0);
+    }
+
+    virtual ~SnapshotBuffer() {
+
+    }
+
+    // returns a snapshot nobody reads right now, or nullptr if all are in use
+    Snapshot *edit() {
+      int current = _current.load();
+
+      for (int i = 0; i < SNAPSHOT_BUFFER_COUNT; i++) {
+        if (i != current && _readers[i].load() == 0) {
+          return &_snapshots[i];
+        }
+      }
+
+      return nullptr;
+    }
+
+    void publish(Snapshot *snapshot) {
+      _current.store((int)(snapshot - _snapshots));
+    }
+
+    // readers never wait for the writer, they only retry if a snapshot got published in between
+    const Snapshot *acquire() const {
+      while (true) {
+        int index = _current.load();
+        _readers[index].fetch_add(1);
+
+        if (_current.load() == index) {
+          return &_snapshots[index];
+        }
+
+        _readers[index].fetch_sub(1);
+      }
+    }
+
+    void release(const Snapshot *snapshot) const {
+      _readers[snapshot - _snapshots].fetch_sub(1);
+    }
+  };
+}
@@ -0,0 +1,79 @@
+/*
+ * File: include/spatialGrid.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <linalg.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+#define SPATIAL_GRID_NEIGHBOUR_CELLS 9
+#define SPATIAL_GRID_HALF_NEIGHBOUR_CELLS 5
+
+// cell coordinates are clamped to keep offsets and differences of cells in range
+#define SPATIAL_GRID_MAX_CELL_COORDINATE (1 << 29)
+
+namespace justAnotherVoiceChat {
+  class Client;
+
+  class SpatialGrid {
+  public:
+    typedef std::vector<std::shared_ptr<Client>> cell_t;
+
+  private:
+    float _cellSize;
+    std::unordered_map<uint64_t, cell_t> _cells;
+    std::unordered_map<Client *, uint64_t> _clientCells;
+
+  public:
+    SpatialGrid(float cellSize);
+    virtual ~SpatialGrid();
+
+    void setCellSize(float cellSize);
+    float cellSize() const;
+
+    void insertClient(const std::shared_ptr<Client> &client);
+    void updateClient(const std::shared_ptr<Client> &client);
+    void removeClient(const std::shared_ptr<Client> &client);
+    void clear();
+
+    const std::unordered_map<uint64_t, cell_t> &cells() const;
+    void neighbourCellKeys(linalg::aliases::float3 position, int32_t dimension, uint64_t *cellKeys) const;
+    void halfNeighbourCellKeys(uint64_t cellKey, uint64_t *cellKeys) const;
+    void neighbourClients(linalg::aliases::float3 position, int32_t dimension, std::vector<std::shared_ptr<Client>> &clients) const;
+    bool isNeighbour(linalg::aliases::float3 position, int32_t dimension, linalg::aliases::float3 otherPosition, int32_t otherDimension) const;
+
+  private:
+    int32_t cellCoordinate(float value) const;
+    uint64_t cellKey(int32_t x, int32_t y, uint16_t dimension) const;
+    uint64_t cellKey(linalg::aliases::float3 position, int32_t dimension) const;
+    uint16_t dimensionHash(int32_t dimension) const;
+  };
+}
@@ -0,0 +1,70 @@
+/*
+ * File: include/workerPool.h
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <memory>
+
+namespace justAnotherVoiceChat {
+  typedef std::function<void(size_t worker, size_t begin, size_t end)> WorkerTask_t;
+
+  class WorkerPool {
+  private:
+    std::vector<std::shared_ptr<std::thread>> _threads;
+    std::mutex _mutex;
+    std::condition_variable _workCondition;
+    std::condition_variable _doneCondition;
+
+    WorkerTask_t _task;
+    size_t _count;
+    size_t _pendingWorkers;
+    uint64_t _generation;
+    bool _running;
+
+  public:
+    WorkerPool();
+    virtual ~WorkerPool();
+
+    void setThreadCount(size_t threadCount);
+    size_t threadCount() const;
+
+    void run(size_t count, WorkerTask_t task);
+
+  private:
+    void work(size_t worker, uint64_t generation);
+    void runSlice(size_t worker);
+    void stopThreads();
+  };
+}
@@ -62,6 +62,21 @@ void JV_CreateServer(uint16_t port, const char *teamspeakServerId, uint64_t team
   _server = std::make_shared<justAnotherVoiceChat::Server>(port, std::string(teamspeakServerId), teamspeakChannelId, std::string(teamspeakChannelPassword));
 }
 
+void JV_CreateServerWithMaxClients(uint16_t port, const char *teamspeakServerId, uint64_t teamspeakChannelId, const char *teamspeakChannelPassword, int maxClients) {
+  logMessage("Creating server", LOG_LEVEL_DEBUG);
+
+  logMessage("Locking api server in JV_CreateServerWithMaxClients", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_CreateServerWithMaxClients", LOG_LEVEL_TRACE);
+  if (_server != nullptr) {
+    logMessage("Server already created", LOG_LEVEL_WARNING);
+
+    return;
+  }
+
+  _server = std::make_shared<justAnotherVoiceChat::Server>(port, std::string(teamspeakServerId), teamspeakChannelId, std::string(teamspeakChannelPassword), maxClients);
+}
+
 void JV_DestroyServer() {
   logMessage("Destroying server", LOG_LEVEL_DEBUG);
 
@@ -329,6 +344,28 @@ bool JV_SetClientPositions(clientPosition_t *positionUpdates, int length) {
   return _server->setClientPositions(positionUpdates, length);
 }
 
+bool JV_SetClientDimension(uint16_t clientId, int32_t dimension) {
+  logMessage("Locking api server in JV_SetClientDimension", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetClientDimension", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return false;
+  }
+
+  return _server->setClientDimension(clientId, dimension);
+}
+
+bool JV_SetClientDimensions(clientDimension_t *dimensionUpdates, int length) {
+  logMessage("Locking api server in JV_SetClientDimensions", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetClientDimensions", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return false;
+  }
+
+  return _server->setClientDimensions(dimensionUpdates, length);
+}
+
 bool JV_SetClientVoiceRange(uint16_t clientId, float voiceRange) {
   logMessage("Locking api server in JV_SetClientVoiceRange", LOG_LEVEL_TRACE);
   std::lock_guard<std::mutex> guard(_serverMutex);
@@ -362,6 +399,160 @@ void JV_Set3DSettings(float distanceFactor, float rolloffFactor) {
   _server->set3DSettings(distanceFactor, rolloffFactor);
 }
 
+void JV_SetWorkerThreadCount(int threadCount) {
+  logMessage("Locking api server in JV_SetWorkerThreadCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetWorkerThreadCount", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setWorkerThreadCount(threadCount);
+}
+
+void JV_SetPairwiseEvaluation(bool enabled) {
+  logMessage("Locking api server in JV_SetPairwiseEvaluation", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetPairwiseEvaluation", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setPairwiseEvaluation(enabled);
+}
+
+void JV_SetAudibleRangeFactors(float enterFactor, float exitFactor) {
+  logMessage("Locking api server in JV_SetAudibleRangeFactors", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetAudibleRangeFactors", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setAudibleRangeFactors(enterFactor, exitFactor);
+}
+
+void JV_SetTickRate(int tickRate) {
+  logMessage("Locking api server in JV_SetTickRate", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetTickRate", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setTickRate(tickRate);
+}
+
+int JV_GetTickRate() {
+  logMessage("Locking api server in JV_GetTickRate", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetTickRate", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->tickRate();
+}
+
+uint64_t JV_GetTickOverrunCount() {
+  logMessage("Locking api server in JV_GetTickOverrunCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetTickOverrunCount", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->tickOverruns();
+}
+
+uint64_t JV_GetTickDuration() {
+  logMessage("Locking api server in JV_GetTickDuration", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetTickDuration", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->tickDuration();
+}
+
+uint64_t JV_GetTickSendLatency() {
+  logMessage("Locking api server in JV_GetTickSendLatency", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetTickSendLatency", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->tickSendLatency();
+}
+
+void JV_SetPositionLevelOfDetail(float nearFactor, int farInterval) {
+  logMessage("Locking api server in JV_SetPositionLevelOfDetail", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetPositionLevelOfDetail", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setPositionLevelOfDetail(nearFactor, farInterval);
+}
+
+void JV_SetPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval) {
+  logMessage("Locking api server in JV_SetPositionUpdateThreshold", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetPositionUpdateThreshold", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setPositionUpdateThreshold(distance, rotation, heartbeatInterval);
+}
+
+void JV_SetAudibleClientLimit(int limit, bool preferTalking) {
+  logMessage("Locking api server in JV_SetAudibleClientLimit", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetAudibleClientLimit", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setAudibleClientLimit(limit, preferTalking);
+}
+
+void JV_SetNetworkShardCount(int shardCount) {
+  logMessage("Locking api server in JV_SetNetworkShardCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_SetNetworkShardCount", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return;
+  }
+
+  _server->setNetworkShardCount(shardCount);
+}
+
+int JV_GetNetworkShardCount() {
+  logMessage("Locking api server in JV_GetNetworkShardCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetNetworkShardCount", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->networkShardCount();
+}
+
+uint16_t JV_GetClientPort(uint16_t gameId) {
+  logMessage("Locking api server in JV_GetClientPort", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked api server in JV_GetClientPort", LOG_LEVEL_TRACE);
+  if (_server == nullptr) {
+    return 0;
+  }
+
+  return _server->clientPort(gameId);
+}
+
 bool JV_SetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, float x, float y, float z) {
   logMessage("Locking api server in JV_SetRelativePositionForClient", LOG_LEVEL_TRACE);
   std::lock_guard<std::mutex> guard(_serverMutex);
@@ -28,16 +28,23 @@
 #include "client.h"
 
 #include "log.h"
+#include "packetWriter.h"
+#include "packetReader.h"
 
 #include <math.h>
 
-#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
-
 using namespace justAnotherVoiceChat;
 
 Client::Client(ENetPeer *peer, uint16_t gameId, uint16_t teamspeakId) {
   _peer = peer;
+  _handle = CLIENT_HANDLE_INVALID;
   _gameId = gameId;
+
+  // let the server find the client of a peer directly
+  if (_peer != nullptr) {
+    _peer->data = this;
+  }
+
   _teamspeakId = teamspeakId;
 
   _talking = false;
@@ -45,7 +52,31 @@ Client::Client(ENetPeer *peer, uint16_t gameId, uint16_t teamspeakId) {
   _speakersMuted = false;
   _positionChanged = true;  // set true to update position on first updateClients loop
   _voiceRange = 10;
+  _dimension = 0;
   _nickname = "";
+  _controlMessagePending = false;
+  _audibleClientsChanged = false;
+  _hasNewAudibleClients = false;
+
+  _movedPosition = linalg::aliases::float3(0, 0, 0);
+  _movedRotation = 0;
+  _movedVoiceRange = _voiceRange;
+  _movedDimension = _dimension;
+  _movedTick = 0;
+
+  // the first position packet is always sent
+  _positionPending = true;
+  _positionSentTick = 0;
+
+  _quantizedPositions = false;
+  _positionFrame = 0;
+  _positionKeyframeFrame = 0;
+  _nextPositionKeyframe = 0;
+  _positionBaseKeyframe = -1;
+
+  for (size_t i = 0; i < POSITION_KEYFRAME_HISTORY; i++) {
+    _positionKeyframes[i].frame = 0;
+  }
 
   _muted = false;
   _position.x = 0;
@@ -58,6 +89,18 @@ Client::~Client() {
   disconnect();
 }
 
+void Client::setHandle(clientHandle_t handle) {
+  _handle = handle;
+}
+
+clientHandle_t Client::handle() const {
+  return _handle;
+}
+
+uint32_t Client::slot() const {
+  return clientHandleSlot(_handle);
+}
+
 uint16_t Client::gameId() const {
   return _gameId;
 }
@@ -73,6 +116,10 @@ void Client::disconnect() {
     return;
   }
 
+  if (_peer->data == this) {
+    _peer->data = nullptr;
+  }
+
   enet_peer_disconnect_now(_peer, 0);
   _peer = nullptr;
 }
@@ -81,77 +128,57 @@ bool Client::isConnected() const {
   return _peer != nullptr;
 }
 
-void Client::cleanupKnownClient(std::shared_ptr<Client> client) {
+void Client::cleanupKnownClient(Client *client) {
   // remove client reference from muted list
-  std::unique_lock<std::mutex> mutedGuard(_mutedClientsMutex);
+  _mutedClients.reset(client->slot());
 
-  auto mutedIt = _mutedClients.begin();
-  while (mutedIt != _mutedClients.end()) {
-    if (*mutedIt == client) {
-      mutedIt = _mutedClients.erase(mutedIt);
-    } else {
-      mutedIt++;
-    }
-  }
+  // remove client reference from audible lists, the slot can be reused by a new client
+  _audibleClients.reset(client->slot());
+  _unmutedClients.reset(client->slot());
+  _newAudibleClients.reset(client->slot());
+  _relativeClients.reset(client->slot());
+  _audibleClientsChanged = true;
 
-  mutedGuard.unlock();
+  removeRelativeOffsets(client);
+}
 
-  // remove client reference from audible lists
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
+void Client::addReferencingClient(uint32_t slot) {
+  _referencingClients.set(slot);
+}
 
-  auto addAudibleIt = _addAudibleClients.begin();
-  while (addAudibleIt != _addAudibleClients.end()) {
-    if (*addAudibleIt == client) {
-      addAudibleIt = _addAudibleClients.erase(addAudibleIt);
-    } else {
-      addAudibleIt++;
-    }
-  }
+void Client::removeReferencingClient(uint32_t slot) {
+  _referencingClients.reset(slot);
+}
 
-  auto removeAudibleIt = _removeAudibleClients.begin();
-  while (removeAudibleIt != _removeAudibleClients.end()) {
-    if (*removeAudibleIt == client) {
-      removeAudibleIt = _removeAudibleClients.erase(removeAudibleIt);
-    } else {
-      removeAudibleIt++;
-    }
-  }
+std::vector<Client *> Client::referencingClients(const std::vector<Client *> &slotClients) {
+  std::vector<Client *> clients;
 
-  auto addRelativeAudibleIt = _addRelativeAudibleClients.begin();
-  while (addRelativeAudibleIt != _addRelativeAudibleClients.end()) {
-    if ((*addRelativeAudibleIt).client == client) {
-      addRelativeAudibleIt = _addRelativeAudibleClients.erase(addRelativeAudibleIt);
-    } else {
-      addRelativeAudibleIt++;
+  _referencingClients.forEach([&](uint32_t slot) {
+    if (slot < slotClients.size() && slotClients[slot] != nullptr) {
+      clients.push_back(slotClients[slot]);
     }
-  }
+  });
 
-  auto removeRelativeAudibleIt = _removeRelativeAudibleClients.begin();
-  while (removeRelativeAudibleIt != _removeRelativeAudibleClients.end()) {
-    if (*removeRelativeAudibleIt == client) {
-      removeRelativeAudibleIt = _removeRelativeAudibleClients.erase(removeRelativeAudibleIt);
-    } else {
-      removeRelativeAudibleIt++;
-    }
-  }
+  return clients;
+}
 
-  auto audibleIt = _audibleClients.begin();
-  while (audibleIt != _audibleClients.end()) {
-    if (*audibleIt == client) {
-      audibleIt = _audibleClients.erase(audibleIt);
-    } else {
-      audibleIt++;
-    }
-  }
+std::vector<Client *> Client::referencedClients(const std::vector<Client *> &slotClients) {
+  ClientSet referencedClients;
 
-  auto relativeIt = _relativeAudibleClients.begin();
-  while (relativeIt != _relativeAudibleClients.end()) {
-    if ((*relativeIt).client == client) {
-      relativeIt = _relativeAudibleClients.erase(relativeIt);
-    } else {
-      relativeIt++;
+  referencedClients.assignUnion(referencedClients, _mutedClients);
+  referencedClients.assignUnion(referencedClients, _audibleClients);
+  referencedClients.assignUnion(referencedClients, _unmutedClients);
+  referencedClients.assignUnion(referencedClients, _relativeClients);
+
+  std::vector<Client *> clients;
+
+  referencedClients.forEach([&](uint32_t slot) {
+    if (slot < slotClients.size() && slotClients[slot] != nullptr) {
+      clients.push_back(slotClients[slot]);
     }
-  }
+  });
+
+  return clients;
 }
 
 bool Client::isTalking() const {
@@ -186,6 +213,22 @@ bool Client::isPeer(ENetPeer *peer) {
   return _peer == peer;
 }
 
+ENetPeer *Client::peer() {
+  std::lock_guard<std::mutex> guard(_peerMutex);
+
+  return _peer;
+}
+
+ENetHost *Client::host() {
+  std::lock_guard<std::mutex> guard(_peerMutex);
+
+  if (_peer == nullptr) {
+    return nullptr;
+  }
+
+  return _peer->host;
+}
+
 void Client::setMuted(bool muted) {
   _muted = muted;
 }
@@ -194,54 +237,42 @@ bool Client::isMuted() const {
   return _muted;
 }
 
-void Client::setMutedClient(std::shared_ptr<Client> client, bool muted) {
-  std::lock_guard<std::mutex> guard(_mutedClientsMutex);
-
+void Client::setMutedClient(Client *client, bool muted) {
   if (muted) {
-    // search for already existing muted client
-    for (auto it = _mutedClients.begin(); it != _mutedClients.end(); it++) {
-      if (*it == client) {
-        return;
-      }
-    }
+    _mutedClients.set(client->slot());
+    client->addReferencingClient(slot());
+    return;
+  }
 
-    _mutedClients.push_back(client);
-  } else {
-    // erase all entries pointing to this client
-    auto it = _mutedClients.begin();
-    while (it != _mutedClients.end()) {
-      if (*it == client) {
-        it = _mutedClients.erase(it);
-      } else {
-        it++;
-      }
-    }
+  _mutedClients.reset(client->slot());
+
+  // drop the reference if the client is not known otherwise
+  if (_audibleClients.test(client->slot()) == false && _unmutedClients.test(client->slot()) == false && _relativeClients.test(client->slot()) == false) {
+    client->removeReferencingClient(slot());
   }
 }
 
-bool Client::isMutedClient(std::shared_ptr<Client> client) {
-  std::lock_guard<std::mutex> guard(_mutedClientsMutex);
+bool Client::isMutedClient(Client *client) {
+  return _mutedClients.test(client->slot());
+}
+
+std::vector<Client *> Client::mutedClients(const std::vector<Client *> &slotClients) {
+  std::vector<Client *> clients;
 
-  for (auto it = _mutedClients.begin(); it != _mutedClients.end(); it++) {
-    if (*it == client) {
-      return true;
+  _mutedClients.forEach([&](uint32_t slot) {
+    if (slot < slotClients.size() && slotClients[slot] != nullptr) {
+      clients.push_back(slotClients[slot]);
     }
-  }
-    
-  return false;
+  });
+
+  return clients;
 }
 
 bool Client::handleStatus(ENetPacket *packet, bool *talkingChanged, bool *microphoneChanged, bool *speakersChanged) {
   statusPacket_t statusPacket;
-  
-  std::string data((char *)packet->data, packet->dataLength);
-  std::istringstream is(data);
-
-  try {
-    cereal::BinaryInputArchive archive(is);
-    archive(statusPacket);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
+
+  if (parsePacket(packet, &statusPacket) == false) {
+    logMessage("Invalid status packet of " + std::to_string(packet->dataLength) + " bytes", LOG_LEVEL_WARNING);
     return false;
   }
 
@@ -260,136 +291,126 @@ bool Client::handleStatus(ENetPacket *packet, bool *talkingChanged, bool *microp
   return *talkingChanged || *microphoneChanged || *speakersChanged;
 }
 
-void Client::addAudibleClient(std::shared_ptr<Client> client) {
-  std::unique_lock<std::mutex> muteGuard(_mutedClientsMutex);
+bool Client::handlePositionAck(ENetPacket *packet) {
+  positionAckPacket_t ackPacket;
 
-  if (client == nullptr || client->isMuted()) {
-    return;
+  if (parsePacket(packet, &ackPacket) == false) {
+    logMessage("Invalid position acknowledgement of " + std::to_string(packet->dataLength) + " bytes", LOG_LEVEL_WARNING);
+    return false;
   }
 
-  for (auto it = _mutedClients.begin(); it != _mutedClients.end(); it++) {
-    if (*it == client) {
-      return;
+  for (size_t i = 0; i < POSITION_KEYFRAME_HISTORY; i++) {
+    if (_positionKeyframes[i].frame != ackPacket.frame || ackPacket.frame == 0) {
+      continue;
     }
-  }
-
-  muteGuard.unlock();
 
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
-
-  for (auto it = _audibleClients.begin(); it != _audibleClients.end(); it++) {
-    if (*it == client) {
-      return;
+    // acknowledgements can arrive out of order, only move forward
+    if (_positionBaseKeyframe >= 0 && (int32_t)(ackPacket.frame - _positionKeyframes[_positionBaseKeyframe].frame) <= 0) {
+      return false;
     }
+
+    _positionBaseKeyframe = (int)i;
+    return true;
   }
 
-  _addAudibleClients.push_back(client);
+  // keyframe was already replaced by newer ones
+  return false;
 }
 
-void Client::removeAudibleClient(std::shared_ptr<Client> client) {
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
+bool Client::addAudibleClient(Client *client) {
+  if (client == nullptr || client->isMuted() || _mutedClients.test(client->slot())) {
+    return false;
+  }
 
-  for (auto it = _audibleClients.begin(); it != _audibleClients.end(); it++) {
-    if (*it == client) {
-      _removeAudibleClients.push_back(client);
-      return;
-    }
+  if (_audibleClients.test(client->slot())) {
+    return false;
   }
-}
 
-void Client::addRelativeAudibleClient(std::shared_ptr<Client> client, linalg::aliases::float3 position) {
-  std::unique_lock<std::mutex> muteGuard(_mutedClientsMutex);
+  // the caller adds this client to the referencing clients of the new audible client
+  _audibleClients.set(client->slot());
+  _audibleClientsChanged = true;
 
-  if (client->isMuted()) {
+  return true;
+}
+
+void Client::removeAudibleClient(Client *client) {
+  if (client == nullptr) {
     return;
   }
 
-  for (auto it = _mutedClients.begin(); it != _mutedClients.end(); it++) {
-    if (*it == client) {
-      return;
-    }
+  if (_audibleClients.test(client->slot())) {
+    _audibleClients.reset(client->slot());
+    _audibleClientsChanged = true;
   }
+}
 
-  muteGuard.unlock();
-
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
+void Client::addRelativeAudibleClient(Client *client, linalg::aliases::float3 position) {
+  if (client->isMuted() || _mutedClients.test(client->slot())) {
+    return;
+  }
 
   if (isRelativeClient(client)) {
     return;
   }
 
+  _relativeClients.set(client->slot());
+  _audibleClientsChanged = true;
+  client->addReferencingClient(slot());
+
   _addRelativeAudibleClients.push_back(relativeClient_t());
-  _addRelativeAudibleClients.back().client = client;
+  _addRelativeAudibleClients.back().client = client->handle();
   _addRelativeAudibleClients.back().offset = position;
 }
 
-void Client::removeRelativeAudibleClient(std::shared_ptr<Client> client) {
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
-
+void Client::removeRelativeAudibleClient(Client *client) {
   if (isRelativeClient(client) == false) {
     return;
   }
 
-  _removeRelativeAudibleClients.push_back(client);
+  _relativeClients.reset(client->slot());
+  _audibleClientsChanged = true;
+  removeRelativeOffsets(client);
 }
 
 void Client::removeAllRelativeAudibleClients() {
-  std::lock_guard<std::mutex> guard(_audibleClientsMutex);
-
-  for (auto it = _relativeAudibleClients.begin(); it != _relativeAudibleClients.end(); it++) {
-    _removeRelativeAudibleClients.push_back((*it).client);
-  }
+  _relativeClients.clear();
+  _relativeAudibleClients.clear();
+  _addRelativeAudibleClients.clear();
+  _audibleClientsChanged = true;
 }
 
-void Client::sendUpdate() {
-  // create update packet
-  updatePacket_t updatePacket;
+bool Client::isAudibleClient(Client *client) {
+  return _audibleClients.test(client->slot());
+}
 
-  // send new audible clients
-  std::unique_lock<std::mutex> guard(_audibleClientsMutex);
+std::vector<Client *> Client::audibleClients(const std::vector<Client *> &slotClients) {
+  std::vector<Client *> clients;
 
-  for (auto it = _addAudibleClients.begin(); it != _addAudibleClients.end(); it++) {
-    if (*it == nullptr) {
-      continue;
+  _audibleClients.forEach([&](uint32_t slot) {
+    if (slot < slotClients.size() && slotClients[slot] != nullptr) {
+      clients.push_back(slotClients[slot]);
     }
+  });
 
-    if (isRelativeClient(*it) == false) {
-      // add to update packet
-      clientAudioUpdate_t audioUpdate;
-      audioUpdate.teamspeakId = (*it)->teamspeakId();
-      audioUpdate.muted = false;
-      updatePacket.audioUpdates.push_back(audioUpdate);
-    }
+  return clients;
+}
 
-    _audibleClients.push_back(*it);
-  }
+bool Client::buildUpdatePacket(const std::vector<Client *> &slotClients, std::vector<referenceChange_t> &referenceChanges) {
+  // reuse the vectors of the last update packet
+  updatePacket_t &updatePacket = _updatePacket;
+  updatePacket.audioUpdates.clear();
+  updatePacket.positionUpdates.clear();
 
+  // send offsets of new relative clients once
   for (auto it = _addRelativeAudibleClients.begin(); it != _addRelativeAudibleClients.end(); it++) {
-    if ((*it).client == nullptr) {
+    // skip clients which left since the offset was set
+    auto client = clientByHandle(slotClients, (*it).client);
+    if (client == nullptr) {
       continue;
     }
 
-    // only unmute if also not normal list
-    bool unmute = true;
-
-    for (auto audibleIt = _audibleClients.begin(); audibleIt != _audibleClients.end(); audibleIt++) {
-      if ((*it).client == *audibleIt) {
-        unmute = false;
-        break;
-      }
-    }
-
-    if (unmute) {
-      // add update packet
-      clientAudioUpdate_t audioUpdate;
-      audioUpdate.teamspeakId = (*it).client->teamspeakId();
-      audioUpdate.muted = false;
-      updatePacket.audioUpdates.push_back(audioUpdate);
-    }
-
-    // send offset once
     clientPositionUpdate_t positionUpdate;
-    positionUpdate.teamspeakId = (*it).client->teamspeakId();
+    positionUpdate.teamspeakId = client->teamspeakId();
     positionUpdate.x = (*it).offset.x;
     positionUpdate.y = (*it).offset.y;
     positionUpdate.z = (*it).offset.z;
@@ -400,157 +421,222 @@ void Client::sendUpdate() {
     _relativeAudibleClients.push_back(*it);
   }
 
-  // send removed audible clients
-  for (auto it = _removeAudibleClients.begin(); it != _removeAudibleClients.end(); it++) {
-    if (*it == nullptr) {
-      continue;
+  _addRelativeAudibleClients.clear();
+
+  if (_audibleClientsChanged == false) {
+    // nothing to compare, don't scan the sets of every slot
+    if (_hasNewAudibleClients) {
+      _newAudibleClients.clear();
+      _hasNewAudibleClients = false;
     }
+  } else {
+    // audible and relative clients are unmuted, send every client which changed since the last update
+    _nextUnmutedClients.assignUnion(_audibleClients, _relativeClients);
+    _hasNewAudibleClients = false;
+
+    _nextUnmutedClients.forEachChanged(_unmutedClients, [&](uint32_t slot) {
+      if (slot >= slotClients.size() || slotClients[slot] == nullptr) {
+        return;
+      }
 
-    // only mute if also not relative list
-    if (isRelativeClient(*it) == false) {
-      // add to update packet
       clientAudioUpdate_t audioUpdate;
-      audioUpdate.teamspeakId = (*it)->teamspeakId();
-      audioUpdate.muted = true;
+      audioUpdate.teamspeakId = slotClients[slot]->teamspeakId();
+      audioUpdate.muted = _nextUnmutedClients.test(slot) == false;
       updatePacket.audioUpdates.push_back(audioUpdate);
-    }
 
-    auto removeIt = _audibleClients.begin();
-    while (removeIt != _audibleClients.end()) {
-      if (*removeIt == *it) {
-        removeIt = _audibleClients.erase(removeIt);
-      } else {
-        removeIt++;
+      if (audioUpdate.muted == false) {
+        _hasNewAudibleClients = true;
       }
-    }
+
+      // clients which are muted again are only still known if muted for this client
+      if (audioUpdate.muted && _mutedClients.test(slot) == false) {
+        referenceChange_t referenceChange;
+        referenceChange.client = slotClients[slot];
+        referenceChange.referencingSlot = clientHandleSlot(_handle);
+        referenceChange.referenced = false;
+
+        referenceChanges.push_back(referenceChange);
+      }
+    });
+
+    _newAudibleClients.assignDifference(_nextUnmutedClients, _unmutedClients);
+    _unmutedClients.swap(_nextUnmutedClients);
+    _audibleClientsChanged = false;
   }
 
-  for (auto it = _removeRelativeAudibleClients.begin(); it != _removeRelativeAudibleClients.end(); it++) {
-    if (*it == nullptr) {
-      continue;
-    }
+  // the server serializes the packet once for every listener with the same updates
+  return updatePacket.audioUpdates.empty() == false || updatePacket.positionUpdates.empty() == false;
+}
 
-    // only mute if also not in normal list
-    bool mute = true;
+const updatePacket_t &Client::updatePacket() const {
+  return _updatePacket;
+}
 
-    for (auto audibleIt = _audibleClients.begin(); audibleIt != _audibleClients.end(); audibleIt++) {
-      if (*it == *audibleIt) {
-        mute = false;
-        break;
-      }
-    }
+ENetPacket *Client::createPositionPacket(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval, int heartbeatInterval) {
+  if (positionPacketDue(slotClients, tick, nearFactor, farInterval, heartbeatInterval) == false) {
+    return nullptr;
+  }
 
-    if (mute) {
-      // add update packet
-      clientAudioUpdate_t audioUpdate;
-      audioUpdate.teamspeakId = (*it)->teamspeakId();
-      audioUpdate.muted = true;
-      updatePacket.audioUpdates.push_back(audioUpdate);
-    }
+  _positionPending = false;
+  _positionSentTick = tick;
 
-    auto removeIt = _relativeAudibleClients.begin();
-    while (removeIt != _relativeAudibleClients.end()) {
-      if ((*removeIt).client == *it) {
-        removeIt = _relativeAudibleClients.erase(removeIt);
-      } else {
-        removeIt++;
-      }
-    }
+  if (_quantizedPositions) {
+    return createQuantizedPositionPacket(slotClients, tick, nearFactor, farInterval);
   }
 
-  if (updatePacket.audioUpdates.empty() && updatePacket.positionUpdates.empty()) {
-    // clear update lists
-    _addAudibleClients.clear();
-    _removeAudibleClients.clear();
-    _addRelativeAudibleClients.clear();
-    _removeRelativeAudibleClients.clear();
+  // reuse the vector of the last position packet
+  positionPacket_t &packet = _positionPacket;
+  packet.positions.clear();
+  packet.x = _position.x;
+  packet.y = _position.y;
+  packet.z = _position.z;
+  packet.rotation = _rotation;
 
-    guard.unlock();
+  _audibleClients.forEach([&](uint32_t slot) {
+    clientPositionUpdate_t positionUpdate;
 
-    return;
-  }
+    if (speakerPosition(slotClients, slot, tick, nearFactor, farInterval, &positionUpdate)) {
+      packet.positions.push_back(positionUpdate);
+    }
+  });
 
-  guard.unlock();
+  return createPacket(packet, 0);
+}
 
-  // send update packet
-  std::ostringstream os;
+bool Client::positionPacketDue(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval, int heartbeatInterval) {
+  bool due = _positionPending || _movedTick > _positionSentTick;
 
-  try {
-    cereal::BinaryOutputArchive archive(os);
-    archive(updatePacket);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
-    return;
+  // idle listeners without audible clients have nothing to refresh
+  if (_audibleClients.empty() == false && tick - _positionSentTick >= (uint64_t)heartbeatInterval) {
+    due = true;
   }
 
-  auto data = os.str();
-  sendPacket((void *)data.c_str(), data.size(), NETWORK_UPDATE_CHANNEL);
+  // new audible clients need their first position
+  if (_hasNewAudibleClients) {
+    due = true;
+  }
 
-  // clear update lists
-  guard.lock();
+  // moved clients which are skipped this tick keep the changes pending
+  _audibleClients.forEach([&](uint32_t slot) {
+    if (slot >= slotClients.size() || slotClients[slot] == nullptr || _relativeClients.test(slot)) {
+      return;
+    }
 
-  _addAudibleClients.clear();
-  _removeAudibleClients.clear();
-  _addRelativeAudibleClients.clear();
-  _removeRelativeAudibleClients.clear();
+    auto client = slotClients[slot];
+    uint64_t sentTick = slot < _speakerSentTicks.size() ? _speakerSentTicks[slot] : 0;
 
-  guard.unlock();
+    // skipped far clients keep their change until they are written
+    if (client->movedTick() > sentTick && isSkippedFarClient(client, slot, tick, nearFactor, farInterval) == false) {
+      due = true;
+    }
+  });
+
+  return due;
 }
 
-void Client::sendPositions() {
-  positionPacket_t packet;
+ENetPacket *Client::createQuantizedPositionPacket(const std::vector<Client *> &slotClients, uint64_t tick, float nearFactor, int farInterval) {
+  _positionFrame++;
+
+  // send keyframes until the client acknowledged one, then periodically
+  bool keyframe = _positionBaseKeyframe < 0 || _positionFrame - _positionKeyframeFrame >= POSITION_KEYFRAME_INTERVAL;
+
+  positionKeyframe_t *base = nullptr;
+  positionKeyframe_t *stored = nullptr;
+
+  if (keyframe) {
+    stored = &_positionKeyframes[_nextPositionKeyframe];
+    stored->frame = _positionFrame;
+    stored->positions.clear();
+
+    // the acknowledged keyframe gets replaced, wait for the next acknowledgement
+    if (_positionBaseKeyframe == (int)_nextPositionKeyframe) {
+      _positionBaseKeyframe = -1;
+    }
+
+    _nextPositionKeyframe = (_nextPositionKeyframe + 1) % POSITION_KEYFRAME_HISTORY;
+    _positionKeyframeFrame = _positionFrame;
+  } else {
+    base = &_positionKeyframes[_positionBaseKeyframe];
+  }
+
+  quantizedPositionPacket_t &packet = _quantizedPositionPacket;
+  packet.positions.clear();
+  packet.frame = _positionFrame;
+  packet.baseFrame = keyframe ? _positionFrame : base->frame;
   packet.x = _position.x;
   packet.y = _position.y;
   packet.z = _position.z;
   packet.rotation = _rotation;
 
-  std::unique_lock<std::mutex> guard(_audibleClientsMutex);
+  // keyframes are ordered by slot like the audible clients
+  size_t baseIndex = 0;
 
-  for (auto it = _audibleClients.begin(); it != _audibleClients.end(); it++) {
-    if (*it == nullptr) {
-      continue;
+  _audibleClients.forEach([&](uint32_t slot) {
+    clientPositionUpdate_t positionUpdate;
+
+    // keyframes contain every audible client
+    if (speakerPosition(slotClients, slot, tick, nearFactor, keyframe ? 1 : farInterval, &positionUpdate) == false) {
+      return;
     }
 
-    if (isRelativeClient(*it)) {
-      continue;
+    quantizedPosition_t position;
+    position.client = slotClients[slot]->handle();
+    position.x = quantizeCoordinate(positionUpdate.x);
+    position.y = quantizeCoordinate(positionUpdate.y);
+    position.z = quantizeCoordinate(positionUpdate.z);
+    position.voiceRange = quantizeVoiceRange(positionUpdate.voiceRange);
+
+    if (stored != nullptr) {
+      stored->positions.push_back(position);
     }
 
-    // calculate relative position
-    float x = (*it)->position().x - _position.x;
-    float y = (*it)->position().y - _position.y;
+    const quantizedPosition_t *basePosition = nullptr;
 
-    float rotatedX = x * cos(_rotation) - y * sin(_rotation);
-    float rotatedY = x * sin(_rotation) + y * cos(_rotation);
+    if (base != nullptr) {
+      while (baseIndex < base->positions.size() && clientHandleSlot(base->positions[baseIndex].client) < slot) {
+        baseIndex++;
+      }
 
-    rotatedX *= 10 / (*it)->voiceRange();
-    rotatedY *= 10 / (*it)->voiceRange();
+      // reused slots have a different handle than in the keyframe
+      if (baseIndex < base->positions.size() && base->positions[baseIndex].client == position.client) {
+        basePosition = &base->positions[baseIndex];
+      }
+    }
 
-    // create update packet
-    clientPositionUpdate_t positionUpdate;
-    positionUpdate.teamspeakId = (*it)->teamspeakId();
-    positionUpdate.x = rotatedX;
-    positionUpdate.y = rotatedY;
-    positionUpdate.z = 0;
-    positionUpdate.voiceRange = (*it)->voiceRange();
+    quantizedPositionUpdate_t update;
+    update.teamspeakId = positionUpdate.teamspeakId;
 
-    packet.positions.push_back(positionUpdate);
-  }
+    int deltaX = basePosition == nullptr ? 0 : position.x - basePosition->x;
+    int deltaY = basePosition == nullptr ? 0 : position.y - basePosition->y;
+    int deltaZ = basePosition == nullptr ? 0 : position.z - basePosition->z;
 
-  guard.unlock();
+    if (basePosition != nullptr && basePosition->voiceRange == position.voiceRange &&
+        deltaX >= INT8_MIN && deltaX <= INT8_MAX && deltaY >= INT8_MIN && deltaY <= INT8_MAX && deltaZ >= INT8_MIN && deltaZ <= INT8_MAX) {
+      update.flags = 0;
+      update.x = (int16_t)deltaX;
+      update.y = (int16_t)deltaY;
+      update.z = (int16_t)deltaZ;
+      update.voiceRange = 0;
+    } else {
+      update.flags = POSITION_UPDATE_FLAG_FULL;
+      update.x = position.x;
+      update.y = position.y;
+      update.z = position.z;
+      update.voiceRange = position.voiceRange;
+    }
 
-  // serialize packet
-  std::ostringstream os;
+    packet.positions.push_back(update);
+  });
 
-  try {
-    cereal::BinaryOutputArchive archive(os);
-    archive(packet);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
-    return;
-  }
+  return createPacket(packet, 0);
+}
 
-  auto data = os.str();
-  sendPacket((void *)data.c_str(), data.size(), NETWORK_POSITION_CHANNEL, false);
+void Client::setQuantizedPositions(bool enabled) {
+  _quantizedPositions = enabled;
+}
+
+bool Client::quantizedPositions() const {
+  return _quantizedPositions;
 }
 
 void Client::setPosition(linalg::aliases::float3 position) {
@@ -579,6 +665,10 @@ float Client::rotation() const {
   return _rotation;
 }
 
+void Client::setPositionChanged() {
+  _positionChanged = true;
+}
+
 void Client::resetPositionChanged() {
   _positionChanged = false;
 }
@@ -587,6 +677,28 @@ bool Client::positionChanged() const {
   return _positionChanged;
 }
 
+void Client::updateMovement(uint64_t tick, float distanceThreshold, float rotationThreshold) {
+  // small movements add up until they pass the threshold
+  bool moved = linalg::distance2(_position, _movedPosition) > distanceThreshold * distanceThreshold ||
+    fabs(_rotation - _movedRotation) > rotationThreshold ||
+    _voiceRange != _movedVoiceRange ||
+    _dimension != _movedDimension;
+
+  if (moved == false) {
+    return;
+  }
+
+  _movedPosition = _position;
+  _movedRotation = _rotation;
+  _movedVoiceRange = _voiceRange;
+  _movedDimension = _dimension;
+  _movedTick = tick;
+}
+
+uint64_t Client::movedTick() const {
+  return _movedTick;
+}
+
 void Client::setVoiceRange(float range) {
   if (range == _voiceRange) {
     return;
@@ -600,59 +712,155 @@ float Client::voiceRange() const {
   return _voiceRange;
 }
 
+void Client::setDimension(int32_t dimension) {
+  if (dimension == _dimension) {
+    return;
+  }
+
+  _dimension = dimension;
+  _positionChanged = true;
+}
+
+int32_t Client::dimension() const {
+  return _dimension;
+}
+
 void Client::setNickname(std::string nickname) {
   _nickname = nickname;
 
-  sendControlMessage();
+  // sent with the packets of the next update
+  _controlMessagePending = true;
 }
 
 std::string Client::nickname() const {
   return _nickname;
 }
 
-void Client::sendControlMessage() {
+ENetPacket *Client::createControlPacket() {
+  if (_controlMessagePending == false) {
+    return nullptr;
+  }
+
+  _controlMessagePending = false;
+
   // create control packet
   controlPacket_t controlPacket;
   controlPacket.nickname = _nickname;
 
-  // send update packet
-  std::ostringstream os;
+  return createPacket(controlPacket, ENET_PACKET_FLAG_RELIABLE);
+}
 
-  try {
-    cereal::BinaryOutputArchive archive(os);
-    archive(controlPacket);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
+void Client::sendPacket(ENetPacket *packet, int channel) {
+  if (packet == nullptr) {
     return;
   }
 
-  auto data = os.str();
-  sendPacket((void *)data.c_str(), data.size(), NETWORK_CONTROL_CHANNEL);
+  if (queuePacket(packet, channel) == false) {
+    // packet was not queued, so nobody else references it
+    if (packet->referenceCount == 0) {
+      enet_packet_destroy(packet);
+    }
+  }
 }
 
-void Client::sendPacket(void *data, size_t length, int channel, bool reliable) {
+bool Client::queuePacket(ENetPacket *packet, int channel) {
   std::lock_guard<std::mutex> guard(_peerMutex);
 
-  if (_peer == nullptr) {
-    return;
+  if (packet == nullptr || _peer == nullptr) {
+    return false;
   }
 
-  enet_uint32 flags = 0;
+  // shared packets are freed by enet once every peer sent them
+  return enet_peer_send(_peer, (enet_uint8)channel, packet) == 0;
+}
 
-  if (reliable) {
-    flags = ENET_PACKET_FLAG_RELIABLE;
+bool Client::isSkippedFarClient(Client *client, uint32_t slot, uint64_t tick, float nearFactor, int farInterval) {
+  if (farInterval <= 1) {
+    return false;
   }
 
-  ENetPacket *packet = enet_packet_create(data, (int)length, flags);
-  enet_peer_send(_peer, (enet_uint8)channel, packet);
+  float x = client->position().x - _position.x;
+  float y = client->position().y - _position.y;
+
+  // far clients are only updated every few ticks, spread by their id
+  float nearRange = client->voiceRange() * nearFactor;
+
+  return x * x + y * y > nearRange * nearRange && (tick + client->gameId()) % farInterval != 0 && _newAudibleClients.test(slot) == false;
 }
 
-bool Client::isRelativeClient(std::shared_ptr<Client> client) const {
-  for (auto it = _relativeAudibleClients.begin(); it != _relativeAudibleClients.end(); it++) {
-    if ((*it).client == client) {
-      return true;
+bool Client::speakerPosition(const std::vector<Client *> &slotClients, uint32_t slot, uint64_t tick, float nearFactor, int farInterval, clientPositionUpdate_t *positionUpdate) {
+  if (slot >= slotClients.size() || slotClients[slot] == nullptr) {
+    return false;
+  }
+
+  // offsets of relative clients are only sent once
+  if (_relativeClients.test(slot)) {
+    return false;
+  }
+
+  auto client = slotClients[slot];
+
+  // calculate relative position
+  float x = client->position().x - _position.x;
+  float y = client->position().y - _position.y;
+
+  float rotatedX = x * cos(_rotation) - y * sin(_rotation);
+  float rotatedY = x * sin(_rotation) + y * cos(_rotation);
+
+  if (isSkippedFarClient(client, slot, tick, nearFactor, farInterval)) {
+    return false;
+  }
+
+  rotatedX *= 10 / client->voiceRange();
+  rotatedY *= 10 / client->voiceRange();
+
+  positionUpdate->teamspeakId = client->teamspeakId();
+  positionUpdate->x = rotatedX;
+  positionUpdate->y = rotatedY;
+  positionUpdate->z = 0;
+  positionUpdate->voiceRange = client->voiceRange();
+
+  // movements of this speaker are known to the listener from now on
+  if (slot >= _speakerSentTicks.size()) {
+    _speakerSentTicks.resize(slot + 1, 0);
+  }
+
+  _speakerSentTicks[slot] = tick;
+
+  return true;
+}
+
+Client *Client::clientByHandle(const std::vector<Client *> &slotClients, clientHandle_t handle) {
+  uint32_t slot = clientHandleSlot(handle);
+
+  // outdated handles point to a reused slot with a newer generation
+  if (slot >= slotClients.size() || slotClients[slot] == nullptr || slotClients[slot]->handle() != handle) {
+    return nullptr;
+  }
+
+  return slotClients[slot];
+}
+
+bool Client::isRelativeClient(Client *client) const {
+  return _relativeClients.test(client->slot());
+}
+
+void Client::removeRelativeOffsets(Client *client) {
+  auto it = _relativeAudibleClients.begin();
+  while (it != _relativeAudibleClients.end()) {
+    if ((*it).client == client->handle()) {
+      it = _relativeAudibleClients.erase(it);
+    } else {
+      it++;
     }
   }
 
-  return false;
+  auto addIt = _addRelativeAudibleClients.begin();
+  while (addIt != _addRelativeAudibleClients.end()) {
+    if ((*addIt).client == client->handle()) {
+      addIt = _addRelativeAudibleClients.erase(addIt);
+    } else {
+      addIt++;
+    }
+  }
 }
@@ -0,0 +1,110 @@
+/*
+ * File: src/clientSet.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "clientSet.h"
+
+using namespace justAnotherVoiceChat;
+
+ClientSet::ClientSet() {
+
+}
+
+ClientSet::~ClientSet() {
+
+}
+
+void ClientSet::set(uint32_t slot) {
+  size_t index = slot / 64;
+
+  if (index >= _words.size()) {
+    _words.resize(index + 1, 0);
+  }
+
+  _words[index] |= (uint64_t)1 << (slot % 64);
+}
+
+void ClientSet::reset(uint32_t slot) {
+  size_t index = slot / 64;
+
+  if (index >= _words.size()) {
+    return;
+  }
+
+  _words[index] &= ~((uint64_t)1 << (slot % 64));
+}
+
+bool ClientSet::test(uint32_t slot) const {
+  return (word(slot / 64) & ((uint64_t)1 << (slot % 64))) != 0;
+}
+
+void ClientSet::clear() {
+  // keep capacity for the next use
+  for (auto it = _words.begin(); it != _words.end(); it++) {
+    *it = 0;
+  }
+}
+
+bool ClientSet::empty() const {
+  for (auto it = _words.begin(); it != _words.end(); it++) {
+    if (*it != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ClientSet::assignUnion(const ClientSet &set, const ClientSet &otherSet) {
+  size_t size = set._words.size() > otherSet._words.size() ? set._words.size() : otherSet._words.size();
+  _words.resize(size);
+
+  for (size_t i = 0; i < size; i++) {
+    _words[i] = set.word(i) | otherSet.word(i);
+  }
+}
+
+void ClientSet::assignDifference(const ClientSet &set, const ClientSet &otherSet) {
+  size_t size = set._words.size();
+  _words.resize(size);
+
+  for (size_t i = 0; i < size; i++) {
+    _words[i] = set.word(i) & ~otherSet.word(i);
+  }
+}
+
+void ClientSet::swap(ClientSet &set) {
+  _words.swap(set._words);
+}
+
+uint64_t ClientSet::word(size_t index) const {
+  if (index >= _words.size()) {
+    return 0;
+  }
+
+  return _words[index];
+}
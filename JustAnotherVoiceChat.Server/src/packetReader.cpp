@@ -0,0 +1,159 @@
+/*
+ * File: src/packetReader.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "packetReader.h"
+
+#include <string.h>
+
+using namespace justAnotherVoiceChat;
+
+// fixed parts of the packets, cereal prefixes strings with a 64 bit size
+#define PACKET_PROTOCOL_LENGTH (4 * sizeof(uint16_t))
+#define PACKET_HANDSHAKE_MIN_LENGTH (sizeof(int) + 2 * sizeof(uint16_t) + sizeof(uint64_t))
+#define PACKET_STATUS_LENGTH (3 * sizeof(bool))
+#define PACKET_POSITION_ACK_LENGTH sizeof(uint32_t)
+
+PacketReader::PacketReader(const uint8_t *data, size_t length) {
+  _data = data;
+  _length = length;
+  _offset = 0;
+  _failed = false;
+}
+
+PacketReader::~PacketReader() {
+
+}
+
+bool PacketReader::readBool(bool *value) {
+  uint8_t byte;
+  if (read(&byte, sizeof(byte)) == false) {
+    return false;
+  }
+
+  // never load bytes other than 0 and 1 into a bool
+  *value = byte != 0;
+  return true;
+}
+
+bool PacketReader::readUint16(uint16_t *value) {
+  return read(value, sizeof(*value));
+}
+
+bool PacketReader::readInt(int *value) {
+  return read(value, sizeof(*value));
+}
+
+bool PacketReader::readUint32(uint32_t *value) {
+  return read(value, sizeof(*value));
+}
+
+bool PacketReader::readSize(size_t *size) {
+  uint64_t value;
+  if (read(&value, sizeof(value)) == false) {
+    return false;
+  }
+
+  // sizes can never exceed the rest of the packet, so they are rejected before allocating anything
+  if (value > remaining()) {
+    _failed = true;
+    return false;
+  }
+
+  *size = (size_t)value;
+  return true;
+}
+
+bool PacketReader::readString(std::string *value) {
+  size_t size;
+  if (readSize(&size) == false) {
+    return false;
+  }
+
+  value->assign((const char *)_data + _offset, size);
+  _offset += size;
+  return true;
+}
+
+size_t PacketReader::remaining() const {
+  return _length - _offset;
+}
+
+bool PacketReader::failed() const {
+  return _failed;
+}
+
+bool PacketReader::read(void *data, size_t length) {
+  if (_failed || length > remaining()) {
+    _failed = true;
+    return false;
+  }
+
+  memcpy(data, _data + _offset, length);
+  _offset += length;
+  return true;
+}
+
+bool justAnotherVoiceChat::readPacket(PacketReader &reader, protocolPacket_t *packet) {
+  if (reader.remaining() < PACKET_PROTOCOL_LENGTH) {
+    return false;
+  }
+
+  return reader.readUint16(&packet->versionMajor) &&
+    reader.readUint16(&packet->versionMinor) &&
+    reader.readUint16(&packet->minimumVersionMajor) &&
+    reader.readUint16(&packet->minimumVersionMinor);
+}
+
+bool justAnotherVoiceChat::readPacket(PacketReader &reader, handshakePacket_t *packet) {
+  if (reader.remaining() < PACKET_HANDSHAKE_MIN_LENGTH) {
+    return false;
+  }
+
+  return reader.readInt(&packet->statusCode) &&
+    reader.readUint16(&packet->gameId) &&
+    reader.readUint16(&packet->teamspeakId) &&
+    reader.readString(&packet->teamspeakClientUniqueIdentity);
+}
+
+bool justAnotherVoiceChat::readPacket(PacketReader &reader, statusPacket_t *packet) {
+  if (reader.remaining() < PACKET_STATUS_LENGTH) {
+    return false;
+  }
+
+  return reader.readBool(&packet->talking) &&
+    reader.readBool(&packet->microphoneMuted) &&
+    reader.readBool(&packet->speakersMuted);
+}
+
+bool justAnotherVoiceChat::readPacket(PacketReader &reader, positionAckPacket_t *packet) {
+  if (reader.remaining() < PACKET_POSITION_ACK_LENGTH) {
+    return false;
+  }
+
+  return reader.readUint32(&packet->frame);
+}
@@ -0,0 +1,302 @@
+/*
+ * File: src/packetWriter.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "packetWriter.h"
+
+#include <string.h>
+
+using namespace justAnotherVoiceChat;
+
+// cereal prefixes strings and vectors with a 64 bit size
+#define PACKET_SIZE_TAG_LENGTH sizeof(uint64_t)
+
+#define PACKET_AUDIO_UPDATE_LENGTH (sizeof(uint16_t) + sizeof(bool))
+#define PACKET_POSITION_UPDATE_LENGTH (sizeof(uint16_t) + 4 * sizeof(float))
+
+// quantized packets count their entries with 16 bit, entries start with id and flags
+#define PACKET_QUANTIZED_POSITION_HEADER_LENGTH (2 * sizeof(uint32_t) + 4 * sizeof(float) + sizeof(uint16_t))
+#define PACKET_QUANTIZED_UPDATE_LENGTH (sizeof(uint16_t) + sizeof(uint8_t))
+#define PACKET_QUANTIZED_FULL_LENGTH (3 * sizeof(int16_t) + sizeof(uint16_t))
+#define PACKET_QUANTIZED_DELTA_LENGTH (3 * sizeof(int8_t))
+
+#define PACKET_HASH_OFFSET 14695981039346656037ULL
+#define PACKET_HASH_PRIME 1099511628211ULL
+
+static void writePositionUpdate(PacketWriter &writer, const clientPositionUpdate_t &update) {
+  writer.writeUint16(update.teamspeakId);
+  writer.writeFloat(update.x);
+  writer.writeFloat(update.y);
+  writer.writeFloat(update.z);
+  writer.writeFloat(update.voiceRange);
+}
+
+static void hashBytes(uint64_t *hash, const void *data, size_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+
+  // fnv-1a
+  for (size_t i = 0; i < length; i++) {
+    *hash = (*hash ^ bytes[i]) * PACKET_HASH_PRIME;
+  }
+}
+
+static bool isSamePositionUpdate(const clientPositionUpdate_t &update, const clientPositionUpdate_t &otherUpdate) {
+  return update.teamspeakId == otherUpdate.teamspeakId &&
+    update.x == otherUpdate.x &&
+    update.y == otherUpdate.y &&
+    update.z == otherUpdate.z &&
+    update.voiceRange == otherUpdate.voiceRange;
+}
+
+PacketWriter::PacketWriter(uint8_t *data, size_t length) {
+  _data = data;
+  _length = length;
+  _offset = 0;
+  _overflow = false;
+}
+
+PacketWriter::~PacketWriter() {
+
+}
+
+void PacketWriter::writeBool(bool value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeInt8(int8_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeUint8(uint8_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeInt16(int16_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeUint16(uint16_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeInt(int value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeUint32(uint32_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeUint64(uint64_t value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeFloat(float value) {
+  write(&value, sizeof(value));
+}
+
+void PacketWriter::writeSize(size_t size) {
+  writeUint64((uint64_t)size);
+}
+
+void PacketWriter::writeString(const std::string &value) {
+  writeSize(value.size());
+  write(value.data(), value.size());
+}
+
+size_t PacketWriter::offset() const {
+  return _offset;
+}
+
+bool PacketWriter::overflowed() const {
+  return _overflow;
+}
+
+void PacketWriter::write(const void *data, size_t length) {
+  // stop at the first write which does not fit, the packet is discarded anyway
+  if (_overflow || length > _length - _offset) {
+    _overflow = true;
+    return;
+  }
+
+  memcpy(_data + _offset, data, length);
+  _offset += length;
+}
+
+size_t justAnotherVoiceChat::packetSize(const protocolResponsePacket_t &packet) {
+  return sizeof(packet.statusCode) + sizeof(packet.versionMajor) + sizeof(packet.versionMinor);
+}
+
+size_t justAnotherVoiceChat::packetSize(const handshakeResponsePacket_t &packet) {
+  return sizeof(packet.statusCode) +
+    PACKET_SIZE_TAG_LENGTH + packet.reason.size() +
+    PACKET_SIZE_TAG_LENGTH + packet.teamspeakServerUniqueIdentifier.size() +
+    sizeof(packet.channelId) +
+    PACKET_SIZE_TAG_LENGTH + packet.channelPassword.size();
+}
+
+size_t justAnotherVoiceChat::packetSize(const controlPacket_t &packet) {
+  return PACKET_SIZE_TAG_LENGTH + packet.nickname.size();
+}
+
+size_t justAnotherVoiceChat::packetSize(const updatePacket_t &packet) {
+  return PACKET_SIZE_TAG_LENGTH + packet.audioUpdates.size() * PACKET_AUDIO_UPDATE_LENGTH +
+    PACKET_SIZE_TAG_LENGTH + packet.positionUpdates.size() * PACKET_POSITION_UPDATE_LENGTH;
+}
+
+size_t justAnotherVoiceChat::packetSize(const positionPacket_t &packet) {
+  return 4 * sizeof(float) + PACKET_SIZE_TAG_LENGTH + packet.positions.size() * PACKET_POSITION_UPDATE_LENGTH;
+}
+
+size_t justAnotherVoiceChat::packetSize(const quantizedPositionPacket_t &packet) {
+  size_t length = PACKET_QUANTIZED_POSITION_HEADER_LENGTH + packet.positions.size() * PACKET_QUANTIZED_UPDATE_LENGTH;
+
+  for (auto it = packet.positions.begin(); it != packet.positions.end(); it++) {
+    if (((*it).flags & POSITION_UPDATE_FLAG_FULL) != 0) {
+      length += PACKET_QUANTIZED_FULL_LENGTH;
+    } else {
+      length += PACKET_QUANTIZED_DELTA_LENGTH;
+    }
+  }
+
+  return length;
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const protocolResponsePacket_t &packet) {
+  writer.writeInt(packet.statusCode);
+  writer.writeUint16(packet.versionMajor);
+  writer.writeUint16(packet.versionMinor);
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const handshakeResponsePacket_t &packet) {
+  writer.writeInt(packet.statusCode);
+  writer.writeString(packet.reason);
+  writer.writeString(packet.teamspeakServerUniqueIdentifier);
+  writer.writeUint64(packet.channelId);
+  writer.writeString(packet.channelPassword);
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const controlPacket_t &packet) {
+  writer.writeString(packet.nickname);
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const updatePacket_t &packet) {
+  writer.writeSize(packet.audioUpdates.size());
+
+  for (auto it = packet.audioUpdates.begin(); it != packet.audioUpdates.end(); it++) {
+    writer.writeUint16((*it).teamspeakId);
+    writer.writeBool((*it).muted);
+  }
+
+  writer.writeSize(packet.positionUpdates.size());
+
+  for (auto it = packet.positionUpdates.begin(); it != packet.positionUpdates.end(); it++) {
+    writePositionUpdate(writer, *it);
+  }
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const positionPacket_t &packet) {
+  writer.writeFloat(packet.x);
+  writer.writeFloat(packet.y);
+  writer.writeFloat(packet.z);
+  writer.writeFloat(packet.rotation);
+  writer.writeSize(packet.positions.size());
+
+  for (auto it = packet.positions.begin(); it != packet.positions.end(); it++) {
+    writePositionUpdate(writer, *it);
+  }
+}
+
+void justAnotherVoiceChat::writePacket(PacketWriter &writer, const quantizedPositionPacket_t &packet) {
+  writer.writeUint32(packet.frame);
+  writer.writeUint32(packet.baseFrame);
+  writer.writeFloat(packet.x);
+  writer.writeFloat(packet.y);
+  writer.writeFloat(packet.z);
+  writer.writeFloat(packet.rotation);
+  writer.writeUint16((uint16_t)packet.positions.size());
+
+  for (auto it = packet.positions.begin(); it != packet.positions.end(); it++) {
+    writer.writeUint16((*it).teamspeakId);
+    writer.writeUint8((*it).flags);
+
+    if (((*it).flags & POSITION_UPDATE_FLAG_FULL) != 0) {
+      writer.writeInt16((*it).x);
+      writer.writeInt16((*it).y);
+      writer.writeInt16((*it).z);
+      writer.writeUint16((*it).voiceRange);
+    } else {
+      // deltas against the base frame always fit into 8 bit
+      writer.writeInt8((int8_t)(*it).x);
+      writer.writeInt8((int8_t)(*it).y);
+      writer.writeInt8((int8_t)(*it).z);
+    }
+  }
+}
+
+uint64_t justAnotherVoiceChat::packetHash(const updatePacket_t &packet) {
+  uint64_t hash = PACKET_HASH_OFFSET;
+
+  for (auto it = packet.audioUpdates.begin(); it != packet.audioUpdates.end(); it++) {
+    hashBytes(&hash, &(*it).teamspeakId, sizeof((*it).teamspeakId));
+    hashBytes(&hash, &(*it).muted, sizeof((*it).muted));
+  }
+
+  // separate both lists, so moving an entry between them changes the hash
+  size_t audioUpdates = packet.audioUpdates.size();
+  hashBytes(&hash, &audioUpdates, sizeof(audioUpdates));
+
+  for (auto it = packet.positionUpdates.begin(); it != packet.positionUpdates.end(); it++) {
+    hashBytes(&hash, &(*it).teamspeakId, sizeof((*it).teamspeakId));
+    hashBytes(&hash, &(*it).x, sizeof((*it).x));
+    hashBytes(&hash, &(*it).y, sizeof((*it).y));
+    hashBytes(&hash, &(*it).z, sizeof((*it).z));
+    hashBytes(&hash, &(*it).voiceRange, sizeof((*it).voiceRange));
+  }
+
+  return hash;
+}
+
+bool justAnotherVoiceChat::isSamePacket(const updatePacket_t &packet, const updatePacket_t &otherPacket) {
+  if (packet.audioUpdates.size() != otherPacket.audioUpdates.size() || packet.positionUpdates.size() != otherPacket.positionUpdates.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packet.audioUpdates.size(); i++) {
+    if (packet.audioUpdates[i].teamspeakId != otherPacket.audioUpdates[i].teamspeakId || packet.audioUpdates[i].muted != otherPacket.audioUpdates[i].muted) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < packet.positionUpdates.size(); i++) {
+    if (isSamePositionUpdate(packet.positionUpdates[i], otherPacket.positionUpdates[i]) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,211 @@
+/*
+ * File: src/positionTable.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "positionTable.h"
+
+#include "spatialGrid.h"
+#include "client.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define POSITION_TABLE_AVX
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define POSITION_TABLE_SSE
+#endif
+
+using namespace justAnotherVoiceChat;
+
+PositionTable::PositionTable() {
+
+}
+
+PositionTable::~PositionTable() {
+  clear();
+}
+
+void PositionTable::build(const SpatialGrid &grid, bool allChanged) {
+  clear();
+
+  // store clients ordered by their cell to compare whole cells at once
+  auto &cells = grid.cells();
+
+  for (auto it = cells.begin(); it != cells.end(); it++) {
+    cellRange_t cellRange;
+    cellRange.begin = _clients.size();
+    cellRange.changed = false;
+
+    for (auto clientIt = it->second.begin(); clientIt != it->second.end(); clientIt++) {
+      auto client = (*clientIt).get();
+      auto position = client->position();
+
+      uint8_t flags = 0;
+
+      if (allChanged || client->positionChanged()) {
+        flags |= POSITION_FLAG_CHANGED;
+        cellRange.changed = true;
+      }
+
+      if (client->isMuted()) {
+        flags |= POSITION_FLAG_MUTED;
+      }
+
+      _x.push_back(position.x);
+      _y.push_back(position.y);
+      _z.push_back(position.z);
+      _range.push_back(client->voiceRange());
+      _dimension.push_back(client->dimension());
+      _flags.push_back(flags);
+      _clients.push_back(client);
+    }
+
+    cellRange.end = _clients.size();
+    _cellRanges[it->first] = cellRange;
+    _cellKeys.push_back(it->first);
+  }
+}
+
+void PositionTable::clear() {
+  // keep capacity to reuse the memory on the next build
+  _x.clear();
+  _y.clear();
+  _z.clear();
+  _range.clear();
+  _dimension.clear();
+  _flags.clear();
+  _clients.clear();
+  _cellRanges.clear();
+  _cellKeys.clear();
+}
+
+size_t PositionTable::size() const {
+  return _clients.size();
+}
+
+size_t PositionTable::cellCount() const {
+  return _cellKeys.size();
+}
+
+uint64_t PositionTable::cellKey(size_t index) const {
+  return _cellKeys[index];
+}
+
+bool PositionTable::cellRange(uint64_t cellKey, size_t *begin, size_t *end) const {
+  auto it = _cellRanges.find(cellKey);
+  if (it == _cellRanges.end()) {
+    return false;
+  }
+
+  *begin = it->second.begin;
+  *end = it->second.end;
+  return true;
+}
+
+bool PositionTable::cellChanged(uint64_t cellKey) const {
+  auto it = _cellRanges.find(cellKey);
+  if (it == _cellRanges.end()) {
+    return false;
+  }
+
+  return it->second.changed;
+}
+
+Client *PositionTable::client(size_t index) const {
+  return _clients[index];
+}
+
+linalg::aliases::float3 PositionTable::position(size_t index) const {
+  return linalg::aliases::float3(_x[index], _y[index], _z[index]);
+}
+
+float PositionTable::voiceRange(size_t index) const {
+  return _range[index];
+}
+
+int32_t PositionTable::dimension(size_t index) const {
+  return _dimension[index];
+}
+
+uint8_t PositionTable::flags(size_t index) const {
+  return _flags[index];
+}
+
+void PositionTable::addFlags(size_t begin, size_t end, uint8_t flags) {
+  for (size_t i = begin; i < end; i++) {
+    _flags[i] |= flags;
+  }
+}
+
+void PositionTable::squaredDistances(linalg::aliases::float3 position, size_t begin, size_t end, float *distances) const {
+  const float *x = _x.data() + begin;
+  const float *y = _y.data() + begin;
+  const float *z = _z.data() + begin;
+  size_t count = end - begin;
+  size_t i = 0;
+
+#ifdef POSITION_TABLE_AVX
+  __m256 positionX8 = _mm256_set1_ps(position.x);
+  __m256 positionY8 = _mm256_set1_ps(position.y);
+  __m256 positionZ8 = _mm256_set1_ps(position.z);
+
+  for (; i + 8 <= count; i += 8) {
+    __m256 deltaX = _mm256_sub_ps(_mm256_loadu_ps(x + i), positionX8);
+    __m256 deltaY = _mm256_sub_ps(_mm256_loadu_ps(y + i), positionY8);
+    __m256 deltaZ = _mm256_sub_ps(_mm256_loadu_ps(z + i), positionZ8);
+
+    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(deltaX, deltaX), _mm256_mul_ps(deltaY, deltaY)), _mm256_mul_ps(deltaZ, deltaZ));
+    _mm256_storeu_ps(distances + i, distance);
+  }
+#endif
+
+#ifdef POSITION_TABLE_SSE
+  __m128 positionX4 = _mm_set1_ps(position.x);
+  __m128 positionY4 = _mm_set1_ps(position.y);
+  __m128 positionZ4 = _mm_set1_ps(position.z);
+
+  for (; i + 4 <= count; i += 4) {
+    __m128 deltaX = _mm_sub_ps(_mm_loadu_ps(x + i), positionX4);
+    __m128 deltaY = _mm_sub_ps(_mm_loadu_ps(y + i), positionY4);
+    __m128 deltaZ = _mm_sub_ps(_mm_loadu_ps(z + i), positionZ4);
+
+    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY)), _mm_mul_ps(deltaZ, deltaZ));
+    _mm_storeu_ps(distances + i, distance);
+  }
+#endif
+
+  // scalar fallback for the remaining entries
+  for (; i < count; i++) {
+    float deltaX = x[i] - position.x;
+    float deltaY = y[i] - position.y;
+    float deltaZ = z[i] - position.z;
+
+    distances[i] = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+  }
+}
@@ -30,24 +30,86 @@
 #include "internal.h"
 #include "client.h"
 #include "log.h"
-
-#include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
+#include "packetWriter.h"
+#include "packetReader.h"
 
 #include <future>
+#include <algorithm>
+#include <math.h>
 
 using namespace justAnotherVoiceChat;
 
-Server::Server(uint16_t port, std::string teamspeakServerId, uint64_t teamspeakChannelId, std::string teamspeakChannelPassword) {
+Server::Server(uint16_t port, std::string teamspeakServerId, uint64_t teamspeakChannelId, std::string teamspeakChannelPassword, int maxClients) : _spatialGrid(10) {
   _address.host = ENET_HOST_ANY;
   _address.port = port;
 
-  _server = nullptr;
-  _thread = nullptr;
+  // enet is not able to address more peers
+  if (maxClients < 1 || maxClients > ENET_PROTOCOL_MAXIMUM_PEER_ID) {
+    logMessage("Invalid maximum number of clients " + std::to_string(maxClients), LOG_LEVEL_WARNING);
+    maxClients = maxClients < 1 ? 1 : ENET_PROTOCOL_MAXIMUM_PEER_ID;
+  }
+
+  _maxClients = maxClients;
+  _reservedPeers = 0;
+
+  _shardCount = 1;
   _clientUpdateThread = nullptr;
   _running = false;
+  _fullUpdate = false;
+  _pairwiseEvaluation = false;
+  _audibleEnterFactor = 1;
+  _audibleExitFactor = 1;
+  _tickRate = 20;
+  _tickOverruns = 0;
+  _tickDuration = 0;
+  _tickSendLatency = 0;
+  _tick = 0;
+  _positionNearFactor = 1;
+  _positionFarInterval = 1;
+  // every change is sent, unchanged positions are refreshed once a second at the default tick rate
+  _positionDistanceThreshold = 0;
+  _positionRotationThreshold = 0;
+  _positionHeartbeatInterval = 20;
+  _audibleClientLimit = 0;
+  _audibleClientLimitTalking = false;
   _distanceFactor = 1;
   _rolloffFactor = 1;
 
+  _nextWorkerThreadCount = (int)_workerPool.threadCount();
+  _nextPairwiseEvaluation = _pairwiseEvaluation;
+  _nextAudibleEnterFactor = _audibleEnterFactor;
+  _nextAudibleExitFactor = _audibleExitFactor;
+  _nextTickRate = _tickRate;
+  _nextPositionNearFactor = _positionNearFactor;
+  _nextPositionFarInterval = _positionFarInterval;
+  _nextPositionDistanceThreshold = _positionDistanceThreshold;
+  _nextPositionRotationThreshold = _positionRotationThreshold;
+  _nextPositionHeartbeatInterval = _positionHeartbeatInterval;
+  _nextAudibleClientLimit = _audibleClientLimit;
+  _nextAudibleClientLimitTalking = _audibleClientLimitTalking;
+  _settingsVersion = 0;
+  _appliedSettingsVersion = 0;
+
+  _workerDistances.resize(_workerPool.threadCount());
+  _workerCandidates.resize(_workerPool.threadCount());
+  _workerPairs.resize(_workerPool.threadCount());
+  _workerReferenceChanges.resize(_workerPool.threadCount());
+
+  // reserve per client storage once instead of growing it while the server is full
+  _clients.reserve(_maxClients);
+  _slotClients.reserve(_maxClients);
+  _slotGenerations.reserve(_maxClients);
+  _freeSlots.reserve(_maxClients);
+  _dirtyClients.reserve(_maxClients);
+  _updateListeners.reserve(_maxClients);
+  _clientPackets.reserve(_maxClients);
+  _updateRecipients.reserve(_maxClients);
+  _gameIdClients.reserve(_maxClients);
+  _teamspeakIdClients.reserve(_maxClients);
+
+  // queries must find a valid snapshot before the first update
+  publishSnapshot();
+
   _teamspeakServerId = teamspeakServerId;
   _teamspeakChannelId = teamspeakChannelId;
   _teamspeakChannelPassword = teamspeakChannelPassword;
@@ -73,20 +135,49 @@ bool Server::create() {
   }
 
   std::lock_guard<std::mutex> guard(_serverMutex);
-  if (_server != nullptr) {
+  if (_shards.empty() == false) {
     return false;
   }
 
-  _server = enet_host_create(&_address, maxClients(), NETWORK_CHANNELS, 0, 0);
-  if (_server == NULL) {
-    logMessage("Unable to create voice server host", LOG_LEVEL_WARNING);
+  _reservedPeers = 0;
 
-    _server = nullptr;
-    return false;
+  // every shard listens on its own port with its own network thread
+  for (int i = 0; i < _shardCount; i++) {
+    auto shard = std::make_shared<networkShard_t>();
+    shard->address = _address;
+    shard->address.port = (uint16_t)(_address.port + i);
+    shard->wakeupSocket = ENET_SOCKET_NULL;
+    _shards.push_back(shard);
+
+    // each host can take all clients, the limit is checked over all shards
+    shard->host = enet_host_create(&shard->address, maxClients(), NETWORK_CHANNELS, 0, 0);
+    if (shard->host == NULL) {
+      logMessage("Unable to create voice server host on port " + std::to_string(shard->address.port), LOG_LEVEL_WARNING);
+
+      shard->host = nullptr;
+      destroyShards();
+      return false;
+    }
+
+    // lets other threads interrupt the network thread waiting for datagrams
+    if (createWakeupSocket(shard.get()) == false) {
+      logMessage("Unable to create network wakeup socket", LOG_LEVEL_WARNING);
+
+      destroyShards();
+      return false;
+    }
+
+    // negotiated per peer before the handshake creates the client
+    shard->peerQuantizedPositions.assign(_maxClients, false);
+    shard->peerReserved.assign(_maxClients, false);
   }
 
   _running = true;
-  _thread = std::make_shared<std::thread>(&Server::update, this);
+
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    (*it)->thread = std::make_shared<std::thread>(&Server::update, this, (*it).get());
+  }
+
   _clientUpdateThread = std::make_shared<std::thread>(&Server::updateClients, this);
 
   logMessage("Voice server started", LOG_LEVEL_INFO);
@@ -95,7 +186,11 @@ bool Server::create() {
 }
 
 void Server::close() {
-  if (removeAllClients()) {
+  std::unique_lock<std::mutex> clientsGuard(_clientsMutex);
+  bool disconnecting = applyRemoveAllClients();
+  clientsGuard.unlock();
+
+  if (disconnecting) {
     // wait for clients to gracefully disconnect
     std::this_thread::sleep_for(std::chrono::seconds(3));
   }
@@ -103,10 +198,7 @@ void Server::close() {
   abortThreads();
 
   std::lock_guard<std::mutex> guard(_serverMutex);
-  if (_server != nullptr) {
-    enet_host_destroy(_server);
-    _server = nullptr;
-  }
+  destroyShards();
 
   logMessage("Voice server closed", LOG_LEVEL_INFO);
 }
@@ -115,7 +207,7 @@ bool Server::isRunning() {
   logMessage("Locking in isRunning", LOG_LEVEL_TRACE);
   std::lock_guard<std::mutex> guard(_serverMutex);
   logMessage("Locked in isRunning", LOG_LEVEL_TRACE);
-  return (_server != nullptr && _running);
+  return (_shards.empty() == false && _running);
 }
 
 std::string Server::teamspeakServerId() const {
@@ -134,42 +226,89 @@ uint16_t Server::port() const {
   return _address.port;
 }
 
+void Server::setNetworkShardCount(int shardCount) {
+  logMessage("Locking in setNetworkShardCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked in setNetworkShardCount", LOG_LEVEL_TRACE);
+
+  if (shardCount < 1 || shardCount > SERVER_MAX_NETWORK_SHARDS || _address.port + shardCount - 1 > UINT16_MAX) {
+    logMessage("Invalid network shard count " + std::to_string(shardCount), LOG_LEVEL_WARNING);
+    return;
+  }
+
+  // hosts are only created on start
+  if (_shards.empty() == false) {
+    logMessage("Network shard count can't be changed while the server is running", LOG_LEVEL_WARNING);
+    return;
+  }
+
+  _shardCount = shardCount;
+}
+
+int Server::networkShardCount() {
+  logMessage("Locking in networkShardCount", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked in networkShardCount", LOG_LEVEL_TRACE);
+
+  return _shardCount;
+}
+
+uint16_t Server::clientPort(uint16_t gameId) {
+  logMessage("Locking in clientPort", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_serverMutex);
+  logMessage("Locked in clientPort", LOG_LEVEL_TRACE);
+
+  // consecutive game ids are spread evenly over the shards
+  return (uint16_t)(_address.port + gameId % _shardCount);
+}
+
 int Server::maxClients() const {
-  return 256;
+  return _maxClients;
 }
 
 int Server::numberOfClients() const {
-  return (int)_clients.size();
+  const clientSnapshot_t *snapshot = _snapshots.acquire();
+  int numberOfClients = snapshot->numberOfClients;
+  _snapshots.release(snapshot);
+
+  return numberOfClients;
 }
 
 bool Server::removeClient(uint16_t gameId) {
-  logMessage("Locking in removeClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in removeClient", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Client to be removed not found: " + std::to_string(gameId), LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_REMOVE_CLIENT;
+  command.gameId = gameId;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyRemoveClient(uint16_t gameId) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Client to be removed not found: " + std::to_string(gameId), LOG_LEVEL_WARNING);
     return false;
   }
 
-  for (auto it = _clients.begin(); it != _clients.end(); it++) {
-    if (*it == client) {
-      continue;
-    }
+  cleanupClientReferences(client);
 
-    if (*it == nullptr) {
-      logMessage("Nullpointer in client list", LOG_LEVEL_WARNING);
-      continue;
-    }
-    
-    (*it)->cleanupKnownClient(client);
+  _spatialGrid.removeClient(client);
+  removeDirtyClient(client.get());
+
+  // limited listeners around the client have to select their audible clients again
+  if (_audibleClientLimit > 0) {
+    addDirtyClient(nullptr, client->position(), client->dimension());
   }
 
   // get client ip
   logMessage("Client disconnected " + client->endpoint(), LOG_LEVEL_INFO);
 
-  client->disconnect();
+  disconnectClient(client);
 
   logMessage("Removing client from client list", LOG_LEVEL_TRACE);
 
@@ -190,102 +329,272 @@ bool Server::removeClient(uint16_t gameId) {
     }
   }
 
+  removeClientLookup(client);
+  updateSpatialGridCellSize();
+
   logMessage("Removed client " + std::to_string(gameId), LOG_LEVEL_TRACE);
 
   return true;
 }
 
 bool Server::removeAllClients() {
-  logMessage("Locking in removeAllClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in removeAllClient", LOG_LEVEL_TRACE);
+  command_t command = {};
+  command.type = COMMAND_REMOVE_ALL_CLIENTS;
 
+  pushCommand(command);
+  return true;
+}
+
+bool Server::applyRemoveAllClients() {
   if (_clients.empty()) {
     return false;
   }
 
   for (auto it = _clients.begin(); it != _clients.end(); it++) {
     if (*it) {
-      (*it)->disconnect();
+      disconnectClient(*it);
     }
   }
 
   _clients.clear();
+  _gameIdClients.clear();
+
+  _slotClients.clear();
+  _slotGenerations.clear();
+  _freeSlots.clear();
+  _teamspeakIdClients.clear();
+  _spatialGrid.clear();
+  _dirtyClients.clear();
   return true;
 }
 
 bool Server::isClientConnected(uint16_t gameId) {
-  logMessage("Locking in isClientConnected", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in isClientConnected", LOG_LEVEL_TRACE);
+  return isGameIdConnected(gameId);
+}
 
-  for (auto it = _clients.begin(); it != _clients.end(); it++) {
-    if ((*it)->gameId() == gameId) {
-      return true;
-    }
+bool Server::setClientPosition(uint16_t gameId, linalg::aliases::float3 position, float rotation) {
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for position", LOG_LEVEL_WARNING);
+    return false;
   }
 
-  return false;
-}
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_POSITION;
+  command.gameId = gameId;
+  command.position = position;
+  command.value = rotation;
 
-bool Server::setClientPosition(uint16_t gameId, linalg::aliases::float3 position, float rotation) {
-  logMessage("Locking in setClientPosition", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in setClientPosition", LOG_LEVEL_TRACE);
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyClientPosition(uint16_t gameId, linalg::aliases::float3 position, float rotation) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Unable to find client " + std::to_string(gameId) + " for position", LOG_LEVEL_WARNING);
     return false;
   }
 
+  if (isValidPosition(position, rotation) == false) {
+    logMessage("Invalid position of client " + std::to_string(gameId), LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  bool clean = client->positionChanged() == false;
+  auto previousPosition = client->position();
+  auto previousDimension = client->dimension();
+
   client->setPosition(position);
   client->setRotation(rotation);
+
+  _spatialGrid.updateClient(client);
+
+  if (clean && client->positionChanged()) {
+    addDirtyClient(client.get(), previousPosition, previousDimension);
+  }
+
   return true;
 }
 
 bool Server::setClientPositions(clientPosition_t *positionUpdates, int length) {
-  logMessage("Locking in setClientPositions", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex); 
-  logMessage("Locked in setClientPositions", LOG_LEVEL_TRACE);
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_POSITIONS;
+
+  bool success = true;
+
+  if (positionUpdates != nullptr && length > 0) {
+    command.positions.assign(positionUpdates, positionUpdates + length);
+
+    // unknown clients are skipped when the command is applied
+    const clientSnapshot_t *snapshot = _snapshots.acquire();
+
+    for (int i = 0; i < length; i++) {
+      if (snapshot->connectedClients.test(positionUpdates[i].gameId) == false) {
+        success = false;
+      }
+    }
+
+    _snapshots.release(snapshot);
+  }
 
+  pushCommand(command);
+  return success;
+}
+
+bool Server::applyClientPositions(const clientPosition_t *positionUpdates, int length) {
   bool success = true;
 
   for (int i = 0; i < length; i++) {
-    auto client = clientByGameId(positionUpdates[i].gameId);
+    auto &client = clientByGameId(positionUpdates[i].gameId);
     if (client == nullptr) {
       success = false;
       continue;
     }
 
-    client->setPosition(linalg::aliases::float3(positionUpdates[i].x, positionUpdates[i].y, positionUpdates[i].z));
+    linalg::aliases::float3 position(positionUpdates[i].x, positionUpdates[i].y, positionUpdates[i].z);
+
+    if (isValidPosition(position, positionUpdates[i].rotation) == false) {
+      logMessage("Invalid position of client " + std::to_string(positionUpdates[i].gameId), LOG_LEVEL_WARNING);
+      success = false;
+      continue;
+    }
+
+    bool clean = client->positionChanged() == false;
+    auto previousPosition = client->position();
+    auto previousDimension = client->dimension();
+
+    client->setPosition(position);
     client->setRotation(positionUpdates[i].rotation);
+
+    _spatialGrid.updateClient(client);
+
+    if (clean && client->positionChanged()) {
+      addDirtyClient(client.get(), previousPosition, previousDimension);
+    }
   }
 
   logMessage("Positions updated", LOG_LEVEL_TRACE);
   return success;
 }
 
+bool Server::setClientDimension(uint16_t gameId, int32_t dimension) {
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for dimension", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_DIMENSION;
+  command.gameId = gameId;
+  command.dimension = dimension;
+
+  pushCommand(command);
+  return true;
+}
+
+bool Server::applyClientDimension(uint16_t gameId, int32_t dimension) {
+  auto client = clientByGameId(gameId);
+  if (client == nullptr) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for dimension", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  updateClientDimension(client, dimension);
+  return true;
+}
+
+bool Server::setClientDimensions(clientDimension_t *dimensionUpdates, int length) {
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_DIMENSIONS;
+
+  bool success = true;
+
+  if (dimensionUpdates != nullptr && length > 0) {
+    command.dimensions.assign(dimensionUpdates, dimensionUpdates + length);
+
+    // unknown clients are skipped when the command is applied
+    const clientSnapshot_t *snapshot = _snapshots.acquire();
+
+    for (int i = 0; i < length; i++) {
+      if (snapshot->connectedClients.test(dimensionUpdates[i].gameId) == false) {
+        success = false;
+      }
+    }
+
+    _snapshots.release(snapshot);
+  }
+
+  pushCommand(command);
+  return success;
+}
+
+bool Server::applyClientDimensions(const clientDimension_t *dimensionUpdates, int length) {
+  bool success = true;
+
+  for (int i = 0; i < length; i++) {
+    auto &client = clientByGameId(dimensionUpdates[i].gameId);
+    if (client == nullptr) {
+      success = false;
+      continue;
+    }
+
+    updateClientDimension(client, dimensionUpdates[i].dimension);
+  }
+
+  logMessage("Dimensions updated", LOG_LEVEL_TRACE);
+  return success;
+}
+
 bool Server::setClientVoiceRange(uint16_t gameId, float voiceRange) {
-  logMessage("Locking in setClientVoiceRange", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in setClientVoiceRange", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for voice range", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_VOICE_RANGE;
+  command.gameId = gameId;
+  command.value = voiceRange;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyClientVoiceRange(uint16_t gameId, float voiceRange) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Unable to find client " + std::to_string(gameId) + " for voice range", LOG_LEVEL_WARNING);
     return false;
   }
 
+  bool clean = client->positionChanged() == false;
+
   client->setVoiceRange(voiceRange);
+
+  if (clean && client->positionChanged()) {
+    addDirtyClient(client.get(), client->position(), client->dimension());
+  }
+
+  updateSpatialGridCellSize();
   return true;
 }
 
 bool Server::setClientNickname(uint16_t gameId, std::string nickname) {
-  logMessage("Locking in setClientNickname", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in setClientNickname", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for nickname", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_SET_CLIENT_NICKNAME;
+  command.gameId = gameId;
+  command.text = nickname;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyClientNickname(uint16_t gameId, std::string nickname) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Unable to find client " + std::to_string(gameId) + " for nickname", LOG_LEVEL_WARNING);
@@ -297,10 +606,22 @@ bool Server::setClientNickname(uint16_t gameId, std::string nickname) {
 }
 
 bool Server::setRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, linalg::aliases::float3 position) {
-  logMessage("Locking in setRelativePositionForClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in setRelativePositionForClient", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(listenerId) == false || isGameIdConnected(speakerId) == false) {
+    logMessage("Unable to find client " + std::to_string(listenerId) + " for relative position", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_SET_RELATIVE_POSITION;
+  command.gameId = listenerId;
+  command.otherGameId = speakerId;
+  command.position = position;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyRelativePositionForClient(uint16_t listenerId, uint16_t speakerId, linalg::aliases::float3 position) {
   auto client = clientByGameId(listenerId);
   auto speaker = clientByGameId(speakerId);
   if (client == nullptr || speaker == nullptr) {
@@ -308,15 +629,26 @@ bool Server::setRelativePositionForClient(uint16_t listenerId, uint16_t speakerI
     return false;
   }
 
-  client->addRelativeAudibleClient(speaker, position);
+  client->addRelativeAudibleClient(speaker.get(), position);
   return true;
 }
 
 bool Server::resetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId) {
-  logMessage("Locking in resetRelativePositionForClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in resetRelativePositionForClient", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(listenerId) == false || isGameIdConnected(speakerId) == false) {
+    logMessage("Unable to find client " + std::to_string(listenerId) + " for relative position reset", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_RESET_RELATIVE_POSITION;
+  command.gameId = listenerId;
+  command.otherGameId = speakerId;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyResetRelativePositionForClient(uint16_t listenerId, uint16_t speakerId) {
   auto client = clientByGameId(listenerId);
   auto speaker = clientByGameId(speakerId);
   if (client == nullptr || speaker == nullptr) {
@@ -324,15 +656,25 @@ bool Server::resetRelativePositionForClient(uint16_t listenerId, uint16_t speake
     return false;
   }
 
-  client->removeRelativeAudibleClient(speaker);
+  client->removeRelativeAudibleClient(speaker.get());
   return true;
 }
 
 bool Server::resetAllRelativePositions(uint16_t gameId) {
-  logMessage("Locking in resetAllRelativePositions", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in resetAllRelativePositions", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for reset all relative positions", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_RESET_ALL_RELATIVE_POSITIONS;
+  command.gameId = gameId;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyResetAllRelativePositions(uint16_t gameId) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Unable to find client " + std::to_string(gameId) + " for reset all relative positions", LOG_LEVEL_WARNING);
@@ -343,6 +685,103 @@ bool Server::resetAllRelativePositions(uint16_t gameId) {
   return true;
 }
 
+void Server::setWorkerThreadCount(int threadCount) {
+  if (threadCount < 1) {
+    threadCount = 1;
+  }
+
+  _nextWorkerThreadCount = threadCount;
+  _settingsVersion++;
+}
+
+int Server::workerThreadCount() const {
+  return _nextWorkerThreadCount;
+}
+
+void Server::setPairwiseEvaluation(bool enabled) {
+  _nextPairwiseEvaluation = enabled;
+  _settingsVersion++;
+}
+
+bool Server::pairwiseEvaluation() const {
+  return _nextPairwiseEvaluation;
+}
+
+void Server::setAudibleRangeFactors(float enterFactor, float exitFactor) {
+  if (enterFactor <= 0) {
+    logMessage("Invalid audible enter factor " + std::to_string(enterFactor), LOG_LEVEL_WARNING);
+    return;
+  }
+
+  // clients have to leave at least at the range they entered
+  if (exitFactor < enterFactor) {
+    exitFactor = enterFactor;
+  }
+
+  _nextAudibleEnterFactor = enterFactor;
+  _nextAudibleExitFactor = exitFactor;
+  _settingsVersion++;
+}
+
+void Server::setTickRate(int tickRate) {
+  if (tickRate < 1 || tickRate > 1000) {
+    logMessage("Invalid tick rate " + std::to_string(tickRate), LOG_LEVEL_WARNING);
+    return;
+  }
+
+  _nextTickRate = tickRate;
+  _settingsVersion++;
+}
+
+int Server::tickRate() {
+  return _nextTickRate;
+}
+
+uint64_t Server::tickOverruns() {
+  return _tickOverruns;
+}
+
+uint64_t Server::tickDuration() {
+  return _tickDuration;
+}
+
+uint64_t Server::tickSendLatency() {
+  return _tickSendLatency;
+}
+
+void Server::setPositionLevelOfDetail(float nearFactor, int farInterval) {
+  if (nearFactor < 0 || farInterval < 1) {
+    logMessage("Invalid position level of detail " + std::to_string(nearFactor) + " " + std::to_string(farInterval), LOG_LEVEL_WARNING);
+    return;
+  }
+
+  _nextPositionNearFactor = nearFactor;
+  _nextPositionFarInterval = farInterval;
+  _settingsVersion++;
+}
+
+void Server::setPositionUpdateThreshold(float distance, float rotation, int heartbeatInterval) {
+  if (distance < 0 || rotation < 0 || heartbeatInterval < 1) {
+    logMessage("Invalid position update threshold " + std::to_string(distance) + " " + std::to_string(rotation) + " " + std::to_string(heartbeatInterval), LOG_LEVEL_WARNING);
+    return;
+  }
+
+  _nextPositionDistanceThreshold = distance;
+  _nextPositionRotationThreshold = rotation;
+  _nextPositionHeartbeatInterval = heartbeatInterval;
+  _settingsVersion++;
+}
+
+void Server::setAudibleClientLimit(int limit, bool preferTalking) {
+  if (limit < 0) {
+    limit = 0;
+  }
+
+  _nextAudibleClientLimit = limit;
+  _nextAudibleClientLimitTalking = preferTalking;
+  _settingsVersion++;
+}
+
 void Server::set3DSettings(float distanceFactor, float rolloffFactor) {
   _distanceFactor = distanceFactor;
   _rolloffFactor = rolloffFactor;
@@ -351,227 +790,1124 @@ void Server::set3DSettings(float distanceFactor, float rolloffFactor) {
 }
 
 bool Server::muteClientForAll(uint16_t gameId, bool muted) {
-  logMessage("Locking in muteClientForAll", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in muteClientForAll", LOG_LEVEL_TRACE);
+  if (isGameIdConnected(gameId) == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for mute client for all", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_MUTE_CLIENT_FOR_ALL;
+  command.gameId = gameId;
+  command.flag = muted;
+
+  pushCommand(command);
+  return true;
+}
 
+bool Server::applyMuteClientForAll(uint16_t gameId, bool muted) {
   auto client = clientByGameId(gameId);
   if (client == nullptr) {
     logMessage("Unable to find client " + std::to_string(gameId) + " for mute client for all", LOG_LEVEL_WARNING);
     return false;
   }
 
-  client->setMuted(muted);
+  client->setMuted(muted);
+
+  // limited listeners select their audible clients on the next update
+  if (_audibleClientLimit > 0) {
+    setClientChanged(client.get());
+    return true;
+  }
+
+  if (muted) {
+    // client muted, see if anybody needs to remove it's from his list
+    for (auto it = _clients.begin(); it != _clients.end(); it++) {
+      if (*it == client || *it == nullptr) {
+        continue;
+      }
+
+      (*it)->removeAudibleClient(client.get());
+    }
+  } else {
+    // client unmuted, see if anybody around him can hear him
+    std::vector<std::shared_ptr<Client>> neighbourClients;
+    _spatialGrid.neighbourClients(client->position(), client->dimension(), neighbourClients);
+
+    for (auto it = neighbourClients.begin(); it != neighbourClients.end(); it++) {
+      if (*it == client || *it == nullptr || (*it)->dimension() != client->dimension()) {
+        continue;
+      }
+
+      float enterRange = client->voiceRange() * _audibleEnterFactor;
+
+      if (linalg::distance2(client->position(), (*it)->position()) < enterRange * enterRange && (*it)->addAudibleClient(client.get())) {
+        client->addReferencingClient((*it)->slot());
+      }
+    }
+  }
+
+  return true;
+}
+
+bool Server::isClientMutedForAll(uint16_t gameId) {
+  const clientSnapshot_t *snapshot = _snapshots.acquire();
+  bool connected = snapshot->connectedClients.test(gameId);
+  bool muted = snapshot->mutedClients.test(gameId);
+  _snapshots.release(snapshot);
+
+  if (connected == false) {
+    logMessage("Unable to find client " + std::to_string(gameId) + " for is client muted", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  return muted;
+}
+
+bool Server::muteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted) {
+  if (isGameIdConnected(listenerId) == false || isGameIdConnected(speakerId) == false) {
+    logMessage("Unable to find client " + std::to_string(speakerId) + " for mute client for client", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  command_t command = {};
+  command.type = COMMAND_MUTE_CLIENT_FOR_CLIENT;
+  command.gameId = listenerId;
+  command.otherGameId = speakerId;
+  command.flag = muted;
+
+  pushCommand(command);
+  return true;
+}
+
+bool Server::applyMuteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted) {
+  auto listener = clientByGameId(listenerId);
+  auto speaker = clientByGameId(speakerId);
+  if (listener == nullptr || speaker == nullptr) {
+    logMessage("Unable to find client " + std::to_string(speakerId) + " for mute client for client", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  listener->setMutedClient(speaker.get(), muted);
+
+  // limited listeners select their audible clients on the next update
+  if (_audibleClientLimit > 0) {
+    setClientChanged(listener.get());
+    return true;
+  }
+
+  if (muted) {
+    listener->removeAudibleClient(speaker.get());
+  } else {
+    float enterRange = speaker->voiceRange() * _audibleEnterFactor;
+
+    if (speaker->dimension() == listener->dimension() && linalg::distance2(speaker->position(), listener->position()) < enterRange * enterRange && listener->addAudibleClient(speaker.get())) {
+      speaker->addReferencingClient(listener->slot());
+    }
+  }
+
+  return true;
+}
+
+bool Server::isClientMutedForClient(uint16_t speakerId, uint16_t listenerId) {
+  const clientSnapshot_t *snapshot = _snapshots.acquire();
+  bool connected = snapshot->connectedClients.test(listenerId) && snapshot->connectedClients.test(speakerId);
+  bool muted = std::binary_search(snapshot->mutedClientPairs.begin(), snapshot->mutedClientPairs.end(), ((uint32_t)listenerId << 16) | speakerId);
+  _snapshots.release(snapshot);
+
+  if (connected == false) {
+    logMessage("Unable to find client " + std::to_string(speakerId) + " for voice range", LOG_LEVEL_WARNING);
+    return false;
+  }
+
+  return muted;
+}
+
+void Server::registerClientConnectingCallback(ClientConnectingCallback_t callback) {
+  _clientConnectingCallback = callback;
+}
+
+void Server::registerClientConnectedCallback(ClientCallback_t callback) {
+  _clientConnectedCallback = callback;
+}
+
+void Server::registerClientRejectedCallback(ClientRejectedCallback_t callback) {
+  _clientRejectedCallback = callback;
+}
+
+void Server::registerClientDisconnectedCallback(ClientCallback_t callback) {
+  _clientDisconnectedCallback = callback;
+}
+
+void Server::registerClientTalkingChangedCallback(ClientStatusCallback_t callback) {
+  _clientTalkingChangedCallback = callback;
+}
+
+void Server::registerClientSpeakersMuteChangedCallback(ClientStatusCallback_t callback) {
+  _clientSpeakersMuteChangedCallback = callback;
+}
+
+void Server::registerClientMicrophoneMuteChangedCallback(ClientStatusCallback_t callback) {
+  _clientMicrophoneMuteChangedCallback = callback;
+}
+
+void Server::update(networkShard_t *shard) {
+  ENetEvent event;
+
+  std::unique_lock<std::mutex> guard(shard->mutex);
+  if (shard->host == nullptr) {
+    return;
+  }
+
+  // the host keeps its socket until this thread is joined
+  ENetSocket socket = shard->host->socket;
+  guard.unlock();
+
+  while (_running) {
+    // block without the lock until datagrams arrive or another thread wakes us up
+    waitForNetwork(shard, socket, SERVER_NETWORK_TIMEOUT);
+
+    guard.lock();
+    if (shard->host == nullptr) {
+      return;
+    }
+
+    shard->events.clear();
+
+    // receive once, then drain every event already queued by enet
+    int code = enet_host_service(shard->host, &event, 0);
+
+    while (code > 0) {
+      shard->events.push_back(event);
+      code = enet_host_check_events(shard->host, &event);
+    }
+
+    guard.unlock();
+
+    if (code < 0) {
+      logMessage("Network error: " + std::to_string(code), LOG_LEVEL_ERROR);
+    }
+
+    for (auto it = shard->events.begin(); it != shard->events.end(); it++) {
+      switch ((*it).type) {
+        case ENET_EVENT_TYPE_CONNECT:
+          onClientConnect(*it);
+          break;
+
+        case ENET_EVENT_TYPE_DISCONNECT:
+          onClientDisconnect(*it);
+          break;
+
+        case ENET_EVENT_TYPE_RECEIVE:
+          onClientMessage(*it);
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    // responses of the handlers leave right away instead of with the next service
+    if (shard->events.empty() == false) {
+      guard.lock();
+
+      if (shard->host == nullptr) {
+        return;
+      }
+
+      enet_host_flush(shard->host);
+      guard.unlock();
+    }
+  }
+
+  logMessage("Update thread stopped", LOG_LEVEL_DEBUG);
+}
+
+void Server::waitForNetwork(networkShard_t *shard, ENetSocket socket, enet_uint32 timeout) {
+  ENetSocketSet readSet;
+  ENET_SOCKETSET_EMPTY(readSet);
+  ENET_SOCKETSET_ADD(readSet, socket);
+  ENET_SOCKETSET_ADD(readSet, shard->wakeupSocket);
+
+  ENetSocket maxSocket = socket > shard->wakeupSocket ? socket : shard->wakeupSocket;
+
+  if (enet_socketset_select(maxSocket, &readSet, nullptr, timeout) <= 0 || ENET_SOCKETSET_CHECK(readSet, shard->wakeupSocket) == false) {
+    return;
+  }
+
+  // several wakeups are handled at once
+  uint8_t data[16];
+  ENetBuffer buffer;
+  buffer.data = data;
+  buffer.dataLength = sizeof(data);
+
+  while (enet_socket_receive(shard->wakeupSocket, nullptr, &buffer, 1) > 0) {
+  }
+}
+
+bool Server::createWakeupSocket(networkShard_t *shard) {
+  // a datagram socket on the loopback interface works with the socket sets of every platform
+  shard->wakeupSocket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+  if (shard->wakeupSocket == ENET_SOCKET_NULL) {
+    return false;
+  }
+
+  ENetAddress address;
+  enet_address_set_host(&address, "127.0.0.1");
+  address.port = 0;
+
+  if (enet_socket_bind(shard->wakeupSocket, &address) < 0 || enet_socket_get_address(shard->wakeupSocket, &shard->wakeupAddress) < 0 || enet_socket_set_option(shard->wakeupSocket, ENET_SOCKOPT_NONBLOCK, 1) < 0) {
+    destroyWakeupSocket(shard);
+    return false;
+  }
+
+  return true;
+}
+
+void Server::destroyWakeupSocket(networkShard_t *shard) {
+  if (shard->wakeupSocket == ENET_SOCKET_NULL) {
+    return;
+  }
+
+  enet_socket_destroy(shard->wakeupSocket);
+  shard->wakeupSocket = ENET_SOCKET_NULL;
+}
+
+void Server::wakeNetwork(networkShard_t *shard) {
+  if (shard->wakeupSocket == ENET_SOCKET_NULL) {
+    return;
+  }
+
+  uint8_t data = 0;
+  ENetBuffer buffer;
+  buffer.data = &data;
+  buffer.dataLength = sizeof(data);
+
+  enet_socket_send(shard->wakeupSocket, &shard->wakeupAddress, &buffer, 1);
+}
+
+void Server::destroyShards() {
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    std::lock_guard<std::mutex> guard((*it)->mutex);
+
+    if ((*it)->host != nullptr) {
+      enet_host_destroy((*it)->host);
+      (*it)->host = nullptr;
+    }
+
+    destroyWakeupSocket((*it).get());
+  }
+
+  _shards.clear();
+}
+
+void Server::updateClients() {
+  auto nextTick = std::chrono::steady_clock::now();
+
+  while (_running) {
+    // logMessage("Locking in updateClients", LOG_LEVEL_TRACE);
+    std::unique_lock<std::mutex> guard(_clientsMutex);
+    // logMessage("Locked in updateClients", LOG_LEVEL_TRACE);
+
+    auto tickStart = std::chrono::steady_clock::now();
+
+    // settings and api calls changed since the last update are applied in order
+    applySettings();
+    applyCommands();
+
+    // only recalculate audibility if any client changed since the last update
+    if (_dirtyClients.empty() == false || _fullUpdate) {
+      updateAudibleClients();
+    }
+
+    // position packets are only sent for movements beyond the threshold
+    for (auto it = _dirtyClients.begin(); it != _dirtyClients.end(); it++) {
+      if ((*it).client != nullptr) {
+        (*it).client->updateMovement(_tick, _positionDistanceThreshold, _positionRotationThreshold);
+      }
+    }
+
+    // create packets for all clients in parallel
+    clientPackets_t emptyPackets;
+    emptyPackets.hasUpdate = false;
+    emptyPackets.ownsUpdatePacket = false;
+    emptyPackets.updatePacket = nullptr;
+    emptyPackets.positionPacket = nullptr;
+    emptyPackets.controlPacket = nullptr;
+
+    _clientPackets.assign(_clients.size(), emptyPackets);
+
+    _workerPool.run(_clients.size(), [this](size_t worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        createClientPackets(i, _workerReferenceChanges[worker]);
+      }
+    });
+
+    applyReferenceChanges();
+
+    // listeners with identical updates share one packet
+    createUpdatePackets();
+
+    // every packet of this tick leaves together
+    sendClientPackets();
+
+    _tickSendLatency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tickStart).count();
+
+    // reset position flags of changed clients
+    for (auto it = _dirtyClients.begin(); it != _dirtyClients.end(); it++) {
+      if ((*it).client != nullptr) {
+        (*it).client->resetPositionChanged();
+      }
+    }
+
+    _dirtyClients.clear();
+    _fullUpdate = false;
+    _tick++;
+
+    // let queries read the state of this tick without the lock
+    publishSnapshot();
+
+    // schedule on absolute deadlines to not drift with the duration of the update
+    auto tickDuration = std::chrono::microseconds(1000000 / _tickRate);
+    auto now = std::chrono::steady_clock::now();
+
+    _tickDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - tickStart).count();
+
+    nextTick += tickDuration;
+
+    if (nextTick <= now) {
+      // skip missed ticks instead of catching up in a burst
+      uint64_t missedTicks = (now - nextTick) / tickDuration + 1;
+      nextTick += tickDuration * missedTicks;
+
+      _tickOverruns += missedTicks;
+      logMessage("Client update overran by " + std::to_string(missedTicks) + " ticks", LOG_LEVEL_DEBUG);
+    }
+
+    guard.unlock();
+
+    // wait for next update
+    std::this_thread::sleep_until(nextTick);
+  }
+}
+
+void Server::pushCommand(command_t &command) {
+  if (_running) {
+    _commands.push(command);
+    return;
+  }
+
+  // nothing drains the queue without the update thread, apply the command right away
+  logMessage("Locking in pushCommand", LOG_LEVEL_TRACE);
+  std::lock_guard<std::mutex> guard(_clientsMutex);
+  logMessage("Locked in pushCommand", LOG_LEVEL_TRACE);
+
+  applySettings();
+  applyCommands();
+  applyCommand(command);
+
+  // queries read the applied state right away
+  publishSnapshot();
+}
+
+void Server::applySettings() {
+  uint64_t settingsVersion = _settingsVersion;
+
+  if (settingsVersion == _appliedSettingsVersion) {
+    return;
+  }
+
+  _appliedSettingsVersion = settingsVersion;
+
+  // the pool is idle between the phases of an update
+  size_t threadCount = (size_t)_nextWorkerThreadCount.load();
+
+  if (threadCount != _workerPool.threadCount()) {
+    _workerPool.setThreadCount(threadCount);
+    _workerDistances.resize(_workerPool.threadCount());
+    _workerCandidates.resize(_workerPool.threadCount());
+    _workerPairs.resize(_workerPool.threadCount());
+    _workerReferenceChanges.resize(_workerPool.threadCount());
+  }
+
+  _pairwiseEvaluation = _nextPairwiseEvaluation;
+  _tickRate = _nextTickRate;
+  _positionNearFactor = _nextPositionNearFactor;
+  _positionFarInterval = _nextPositionFarInterval;
+  _positionDistanceThreshold = _nextPositionDistanceThreshold;
+  _positionRotationThreshold = _nextPositionRotationThreshold;
+  _positionHeartbeatInterval = _nextPositionHeartbeatInterval;
+
+  // both factors are stored separately and may be read in between
+  float enterFactor = _nextAudibleEnterFactor;
+  float exitFactor = std::max(_nextAudibleExitFactor.load(), enterFactor);
+
+  if (enterFactor != _audibleEnterFactor || exitFactor != _audibleExitFactor) {
+    _audibleEnterFactor = enterFactor;
+    _audibleExitFactor = exitFactor;
+
+    updateSpatialGridCellSize();
+    _fullUpdate = true;
+  }
+
+  int audibleClientLimit = _nextAudibleClientLimit;
+  bool audibleClientLimitTalking = _nextAudibleClientLimitTalking;
+
+  if (audibleClientLimit != _audibleClientLimit || audibleClientLimitTalking != _audibleClientLimitTalking) {
+    _audibleClientLimit = audibleClientLimit;
+    _audibleClientLimitTalking = audibleClientLimitTalking;
+    _fullUpdate = true;
+  }
+}
+
+void Server::applyCommands() {
+  command_t command;
+
+  while (_commands.pop(command)) {
+    applyCommand(command);
+  }
+}
+
+void Server::applyCommand(command_t &command) {
+  switch (command.type) {
+    case COMMAND_REMOVE_CLIENT:
+      applyRemoveClient(command.gameId);
+      break;
+
+    case COMMAND_REMOVE_ALL_CLIENTS:
+      applyRemoveAllClients();
+      break;
+
+    case COMMAND_SET_CLIENT_POSITION:
+      applyClientPosition(command.gameId, command.position, command.value);
+      break;
+
+    case COMMAND_SET_CLIENT_POSITIONS:
+      applyClientPositions(command.positions.data(), (int)command.positions.size());
+      break;
+
+    case COMMAND_SET_CLIENT_DIMENSION:
+      applyClientDimension(command.gameId, command.dimension);
+      break;
+
+    case COMMAND_SET_CLIENT_DIMENSIONS:
+      applyClientDimensions(command.dimensions.data(), (int)command.dimensions.size());
+      break;
+
+    case COMMAND_SET_CLIENT_VOICE_RANGE:
+      applyClientVoiceRange(command.gameId, command.value);
+      break;
+
+    case COMMAND_SET_CLIENT_NICKNAME:
+      applyClientNickname(command.gameId, command.text);
+      break;
+
+    case COMMAND_SET_RELATIVE_POSITION:
+      applyRelativePositionForClient(command.gameId, command.otherGameId, command.position);
+      break;
+
+    case COMMAND_RESET_RELATIVE_POSITION:
+      applyResetRelativePositionForClient(command.gameId, command.otherGameId);
+      break;
+
+    case COMMAND_RESET_ALL_RELATIVE_POSITIONS:
+      applyResetAllRelativePositions(command.gameId);
+      break;
+
+    case COMMAND_MUTE_CLIENT_FOR_ALL:
+      applyMuteClientForAll(command.gameId, command.flag);
+      break;
+
+    case COMMAND_MUTE_CLIENT_FOR_CLIENT:
+      applyMuteClientForClient(command.otherGameId, command.gameId, command.flag);
+      break;
+
+    default:
+      break;
+  }
+}
+
+void Server::updateAudibleClients() {
+  // gather positions of all clients in a dense table ordered by grid cell
+  _positionTable.build(_spatialGrid, _fullUpdate);
+
+  // listeners around changed speakers have to be recalculated, too
+  for (auto it = _dirtyClients.begin(); it != _dirtyClients.end(); it++) {
+    if ((*it).client != nullptr) {
+      markNeighbourCells((*it).client->position(), (*it).client->dimension());
+    }
+
+    markNeighbourCells((*it).previousPosition, (*it).previousDimension);
+  }
+
+  _updateListeners.clear();
+
+  for (size_t i = 0; i < _positionTable.size(); i++) {
+    if ((_positionTable.flags(i) & (POSITION_FLAG_CHANGED | POSITION_FLAG_UPDATE)) != 0) {
+      _updateListeners.push_back(i);
+    }
+  }
+
+  if (_audibleClientLimit > 0) {
+    // limited listeners have to select from all clients in range
+    _workerPool.run(_updateListeners.size(), [this](size_t worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        updateLimitedListener(_updateListeners[i], _workerDistances[worker], _workerCandidates[worker], _workerReferenceChanges[worker]);
+      }
+    });
+  } else if (_pairwiseEvaluation) {
+    // every worker evaluates the pairs of its own cells once for both directions
+    _workerPool.run(_positionTable.cellCount(), [this](size_t worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        updateCellPairs(_positionTable.cellKey(i), _workerDistances[worker], _workerPairs[worker], _workerReferenceChanges[worker]);
+      }
+    });
+
+    // listeners of neighbour cells can belong to other workers
+    for (auto it = _workerPairs.begin(); it != _workerPairs.end(); it++) {
+      for (auto pairIt = (*it).begin(); pairIt != (*it).end(); pairIt++) {
+        updateAudibility((*pairIt).listener, (*pairIt).speaker, (*pairIt).squaredDistance, _workerReferenceChanges.front());
+      }
+
+      (*it).clear();
+    }
+
+    _workerPool.run(_updateListeners.size(), [this](size_t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        removeDistantAudibleClients(_updateListeners[i]);
+      }
+    });
+  } else {
+    // every worker calculates the audible clients of its own listeners
+    _workerPool.run(_updateListeners.size(), [this](size_t worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        updateListener(_updateListeners[i], _workerDistances[worker], _workerReferenceChanges[worker]);
+      }
+    });
+  }
+
+  applyReferenceChanges();
+
+  // release client references held by the table
+  _positionTable.clear();
+}
+
+void Server::updateListener(size_t index, std::vector<float> &distances, std::vector<referenceChange_t> &referenceChanges) {
+  auto position = _positionTable.position(index);
+  bool positionChanged = (_positionTable.flags(index) & POSITION_FLAG_CHANGED) != 0;
+
+  // only clients in the surrounding cells can be in voice range
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  _spatialGrid.neighbourCellKeys(position, _positionTable.dimension(index), cellKeys);
+
+  for (int cell = 0; cell < SPATIAL_GRID_NEIGHBOUR_CELLS; cell++) {
+    size_t begin;
+    size_t end;
+
+    if (_positionTable.cellRange(cellKeys[cell], &begin, &end) == false) {
+      continue;
+    }
+
+    if (distances.size() < end - begin) {
+      distances.resize(end - begin);
+    }
+
+    _positionTable.squaredDistances(position, begin, end, distances.data());
+
+    for (size_t i = begin; i < end; i++) {
+      // client to be heard
+      if (i == index) {
+        continue;
+      }
+
+      // unchanged listeners only have to be recalculated against changed speakers
+      if (positionChanged == false && (_positionTable.flags(i) & POSITION_FLAG_CHANGED) == 0) {
+        continue;
+      }
+
+      updateAudibility(index, i, distances[i - begin], referenceChanges);
+    }
+  }
+
+  removeDistantAudibleClients(index);
+}
+
+void Server::updateLimitedListener(size_t index, std::vector<float> &distances, std::vector<audibleCandidate_t> &candidates, std::vector<referenceChange_t> &referenceChanges) {
+  auto client = _positionTable.client(index);
+  auto position = _positionTable.position(index);
+  auto audibleClients = client->audibleClients(_slotClients);
+
+  candidates.clear();
+
+  // collect every client in range
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  _spatialGrid.neighbourCellKeys(position, _positionTable.dimension(index), cellKeys);
+
+  for (int cell = 0; cell < SPATIAL_GRID_NEIGHBOUR_CELLS; cell++) {
+    size_t begin;
+    size_t end;
+
+    if (_positionTable.cellRange(cellKeys[cell], &begin, &end) == false) {
+      continue;
+    }
+
+    if (distances.size() < end - begin) {
+      distances.resize(end - begin);
+    }
+
+    _positionTable.squaredDistances(position, begin, end, distances.data());
+
+    for (size_t i = begin; i < end; i++) {
+      if (i == index || (_positionTable.flags(i) & POSITION_FLAG_MUTED) != 0 || _positionTable.dimension(i) != _positionTable.dimension(index)) {
+        continue;
+      }
+
+      float enterRange = _positionTable.voiceRange(i) * _audibleEnterFactor;
+      float exitRange = _positionTable.voiceRange(i) * _audibleExitFactor;
+      float distance = distances[i - begin];
+
+      if (distance >= exitRange * exitRange) {
+        continue;
+      }
+
+      // clients between enter and exit range stay only if they are already audible
+      if (distance >= enterRange * enterRange && client->isAudibleClient(_positionTable.client(i)) == false) {
+        continue;
+      }
+
+      if (client->isMutedClient(_positionTable.client(i))) {
+        continue;
+      }
+
+      audibleCandidate_t candidate;
+      candidate.index = i;
+      candidate.distance = distance;
+      candidate.talking = _audibleClientLimitTalking && _positionTable.client(i)->isTalking();
+
+      candidates.push_back(candidate);
+    }
+  }
+
+  // keep the closest clients, talking ones first
+  size_t limit = (size_t)_audibleClientLimit;
+
+  if (candidates.size() > limit) {
+    std::nth_element(candidates.begin(), candidates.begin() + limit, candidates.end(), [](const audibleCandidate_t &a, const audibleCandidate_t &b) {
+      if (a.talking != b.talking) {
+        return a.talking;
+      }
+
+      return a.distance < b.distance;
+    });
+
+    candidates.resize(limit);
+  }
+
+  for (auto it = candidates.begin(); it != candidates.end(); it++) {
+    addAudibleClient(client, _positionTable.client((*it).index), referenceChanges);
+  }
+
+  // remove every audible client which was not selected
+  for (auto it = audibleClients.begin(); it != audibleClients.end(); it++) {
+    bool selected = false;
+
+    for (auto candidateIt = candidates.begin(); candidateIt != candidates.end(); candidateIt++) {
+      if (_positionTable.client((*candidateIt).index) == *it) {
+        selected = true;
+        break;
+      }
+    }
+
+    if (selected == false) {
+      client->removeAudibleClient(*it);
+    }
+  }
+}
+
+void Server::updateCellPairs(uint64_t cellKey, std::vector<float> &distances, std::vector<audibilityPair_t> &pairs, std::vector<referenceChange_t> &referenceChanges) {
+  uint64_t cellKeys[SPATIAL_GRID_HALF_NEIGHBOUR_CELLS];
+  _spatialGrid.halfNeighbourCellKeys(cellKey, cellKeys);
+
+  // pairs of unchanged clients keep their audibility
+  bool changed = false;
+
+  for (int cell = 0; cell < SPATIAL_GRID_HALF_NEIGHBOUR_CELLS; cell++) {
+    changed = changed || _positionTable.cellChanged(cellKeys[cell]);
+  }
+
+  if (changed == false) {
+    return;
+  }
+
+  size_t begin;
+  size_t end;
+
+  if (_positionTable.cellRange(cellKey, &begin, &end) == false) {
+    return;
+  }
+
+  for (size_t index = begin; index < end; index++) {
+    auto position = _positionTable.position(index);
+    bool positionChanged = (_positionTable.flags(index) & POSITION_FLAG_CHANGED) != 0;
+
+    for (int cell = 0; cell < SPATIAL_GRID_HALF_NEIGHBOUR_CELLS; cell++) {
+      size_t otherBegin;
+      size_t otherEnd;
+
+      if (_positionTable.cellRange(cellKeys[cell], &otherBegin, &otherEnd) == false) {
+        continue;
+      }
+
+      // pairs inside the own cell are only visited once
+      if (cell == 0) {
+        otherBegin = index + 1;
+      }
+
+      if (otherBegin >= otherEnd) {
+        continue;
+      }
+
+      if (distances.size() < otherEnd - otherBegin) {
+        distances.resize(otherEnd - otherBegin);
+      }
+
+      _positionTable.squaredDistances(position, otherBegin, otherEnd, distances.data());
+
+      for (size_t i = otherBegin; i < otherEnd; i++) {
+        if (positionChanged == false && (_positionTable.flags(i) & POSITION_FLAG_CHANGED) == 0) {
+          continue;
+        }
+
+        // both directions share the same distance, only the voice ranges differ
+        updateAudibility(index, i, distances[i - otherBegin], referenceChanges);
+
+        if (cell == 0) {
+          updateAudibility(i, index, distances[i - otherBegin], referenceChanges);
+        } else {
+          audibilityPair_t pair;
+          pair.listener = i;
+          pair.speaker = index;
+          pair.squaredDistance = distances[i - otherBegin];
+
+          pairs.push_back(pair);
+        }
+      }
+    }
+  }
+}
+
+void Server::updateAudibility(size_t listener, size_t speaker, float squaredDistance, std::vector<referenceChange_t> &referenceChanges) {
+  auto client = _positionTable.client(listener);
+  float enterRange = _positionTable.voiceRange(speaker) * _audibleEnterFactor;
+  float exitRange = _positionTable.voiceRange(speaker) * _audibleExitFactor;
+
+  // clients in other dimensions can share a cell, but never hear each other
+  if (_positionTable.dimension(listener) != _positionTable.dimension(speaker)) {
+    client->removeAudibleClient(_positionTable.client(speaker));
+    return;
+  }
+
+  // clients between enter and exit range keep their state to not flap at the edge
+  if ((_positionTable.flags(speaker) & POSITION_FLAG_MUTED) != 0 || squaredDistance >= exitRange * exitRange) {
+    client->removeAudibleClient(_positionTable.client(speaker));
+  } else if (squaredDistance < enterRange * enterRange) {
+    addAudibleClient(client, _positionTable.client(speaker), referenceChanges);
+  }
+}
+
+void Server::addAudibleClient(Client *listener, Client *speaker, std::vector<referenceChange_t> &referenceChanges) {
+  if (listener->addAudibleClient(speaker) == false) {
+    return;
+  }
+
+  // the speaker can belong to another worker
+  referenceChange_t referenceChange;
+  referenceChange.client = speaker;
+  referenceChange.referencingSlot = listener->slot();
+  referenceChange.referenced = true;
+
+  referenceChanges.push_back(referenceChange);
+}
+
+void Server::applyReferenceChanges() {
+  for (auto it = _workerReferenceChanges.begin(); it != _workerReferenceChanges.end(); it++) {
+    for (auto changeIt = (*it).begin(); changeIt != (*it).end(); changeIt++) {
+      if ((*changeIt).referenced) {
+        (*changeIt).client->addReferencingClient((*changeIt).referencingSlot);
+      } else {
+        (*changeIt).client->removeReferencingClient((*changeIt).referencingSlot);
+      }
+    }
+
+    (*it).clear();
+  }
+}
+
+void Server::removeDistantAudibleClients(size_t index) {
+  auto client = _positionTable.client(index);
+  auto position = _positionTable.position(index);
+  bool positionChanged = (_positionTable.flags(index) & POSITION_FLAG_CHANGED) != 0;
+
+  // audible clients which left the surrounding cells are out of range
+  auto audibleClients = client->audibleClients(_slotClients);
+
+  for (auto it = audibleClients.begin(); it != audibleClients.end(); it++) {
+    if (*it == nullptr) {
+      continue;
+    }
+
+    if (positionChanged == false && (*it)->positionChanged() == false) {
+      continue;
+    }
+
+    if (_spatialGrid.isNeighbour(position, _positionTable.dimension(index), (*it)->position(), (*it)->dimension())) {
+      continue;
+    }
+
+    client->removeAudibleClient(*it);
+  }
+}
+
+void Server::markNeighbourCells(linalg::aliases::float3 position, int32_t dimension) {
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  _spatialGrid.neighbourCellKeys(position, dimension, cellKeys);
+
+  for (int cell = 0; cell < SPATIAL_GRID_NEIGHBOUR_CELLS; cell++) {
+    size_t begin;
+    size_t end;
+
+    if (_positionTable.cellRange(cellKeys[cell], &begin, &end)) {
+      _positionTable.addFlags(begin, end, POSITION_FLAG_UPDATE);
+    }
+  }
+}
+
+void Server::createClientPackets(size_t index, std::vector<referenceChange_t> &referenceChanges) {
+  Client *client = _clients[index].get();
+  if (client == nullptr) {
+    return;
+  }
+
+  if (client->isConnected() == false) {
+    logMessage("Client is not connected but in list", LOG_LEVEL_WARNING);
+    return;
+  }
+
+  // collect updates, they are serialized after every listener is done
+  _clientPackets[index].hasUpdate = client->buildUpdatePacket(_slotClients, referenceChanges);
+
+  // create positions after audible list was updated
+  _clientPackets[index].positionPacket = client->createPositionPacket(_slotClients, _tick, _positionNearFactor, _positionFarInterval, _positionHeartbeatInterval);
+
+  // nicknames changed since the last update
+  _clientPackets[index].controlPacket = client->createControlPacket();
+}
+
+void Server::createUpdatePackets() {
+  _updateRecipients.clear();
+
+  for (size_t i = 0; i < _clientPackets.size(); i++) {
+    if (_clientPackets[i].hasUpdate == false) {
+      continue;
+    }
+
+    updateRecipient_t recipient;
+    recipient.hash = packetHash(_clients[i]->updatePacket());
+    recipient.index = i;
+    recipient.host = _clients[i]->host();
+
+    _updateRecipients.push_back(recipient);
+  }
+
+  // identical updates have equal hashes and end up next to each other
+  std::sort(_updateRecipients.begin(), _updateRecipients.end(), [](const updateRecipient_t &a, const updateRecipient_t &b) {
+    if (a.hash != b.hash) {
+      return a.hash < b.hash;
+    }
+
+    return a.index < b.index;
+  });
 
-  // calculate for every other client if mute changed
-  for (auto it = _clients.begin(); it != _clients.end(); it++) {
-    if (*it == client || *it == nullptr) {
-      continue;
+  size_t runBegin = 0;
+
+  for (size_t i = 0; i < _updateRecipients.size(); i++) {
+    if (i > 0 && _updateRecipients[i].hash != _updateRecipients[i - 1].hash) {
+      runBegin = i;
     }
 
-    if (muted) {
-      // client muted, see if anybody needs to remove it's from his list
-      (*it)->removeAudibleClient(client);
-    } else {
-      // client unmuted, see if anybody can hear him
-      if (linalg::distance(client->position(), (*it)->position()) < client->voiceRange()) {
-        (*it)->addAudibleClient(client);
+    size_t index = _updateRecipients[i].index;
+    auto &updatePacket = _clients[index]->updatePacket();
+
+    // reuse the packet of an earlier listener with the same payload, hashes may collide
+    for (size_t other = runBegin; other < i; other++) {
+      size_t otherIndex = _updateRecipients[other].index;
+
+      // reference counts of packets are only safe within the thread of one host
+      if (_updateRecipients[other].host != _updateRecipients[i].host) {
+        continue;
+      }
+
+      if (_clientPackets[otherIndex].ownsUpdatePacket && isSamePacket(_clients[otherIndex]->updatePacket(), updatePacket)) {
+        _clientPackets[index].updatePacket = _clientPackets[otherIndex].updatePacket;
+        break;
       }
     }
-  }
 
-  return true;
+    if (_clientPackets[index].updatePacket == nullptr) {
+      _clientPackets[index].updatePacket = createPacket(updatePacket, ENET_PACKET_FLAG_RELIABLE);
+      _clientPackets[index].ownsUpdatePacket = true;
+    }
+  }
 }
 
-bool Server::isClientMutedForAll(uint16_t gameId) {
-  logMessage("Locking in isClientMutedForAll", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in isClientMutedForAll", LOG_LEVEL_TRACE);
-
-  auto client = clientByGameId(gameId);
-  if (client == nullptr) {
-    logMessage("Unable to find client " + std::to_string(gameId) + " for is client muted", LOG_LEVEL_WARNING);
-    return false;
+void Server::sendClientPackets() {
+  // the network threads must not service their hosts while packets are queued
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    (*it)->mutex.lock();
   }
 
-  return client->isMuted();
-}
-
-bool Server::muteClientForClient(uint16_t speakerId, uint16_t listenerId, bool muted) {
-  logMessage("Locking in muteClientForClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in muteClientForClient", LOG_LEVEL_TRACE);
+  for (size_t i = 0; i < _clients.size(); i++) {
+    if (_clients[i] == nullptr) {
+      continue;
+    }
 
-  auto listener = clientByGameId(listenerId);
-  auto speaker = clientByGameId(speakerId);
-  if (listener == nullptr || speaker == nullptr) {
-    logMessage("Unable to find client " + std::to_string(speakerId) + " for mute client for client", LOG_LEVEL_WARNING);
-    return false;
+    _clients[i]->queuePacket(_clientPackets[i].updatePacket, NETWORK_UPDATE_CHANNEL);
+    _clients[i]->sendPacket(_clientPackets[i].positionPacket, NETWORK_POSITION_CHANNEL);
+    _clients[i]->sendPacket(_clientPackets[i].controlPacket, NETWORK_CONTROL_CHANNEL);
   }
 
-  listener->setMutedClient(speaker, muted);
+  // shared packets are only freed here if no peer queued them
+  for (size_t i = 0; i < _clientPackets.size(); i++) {
+    ENetPacket *packet = _clientPackets[i].updatePacket;
 
-  if (muted) {
-    listener->removeAudibleClient(speaker);
-  } else {
-    if (linalg::distance(speaker->position(), listener->position()) < speaker->voiceRange()) {
-      listener->addAudibleClient(speaker);
+    if (_clientPackets[i].ownsUpdatePacket && packet != nullptr && packet->referenceCount == 0) {
+      enet_packet_destroy(packet);
     }
   }
 
-  return true;
-}
-
-bool Server::isClientMutedForClient(uint16_t speakerId, uint16_t listenerId) {
-  logMessage("Locking in isClientMutedForClient", LOG_LEVEL_TRACE);
-  std::lock_guard<std::mutex> guard(_clientsMutex);
-  logMessage("Locked in isClientMutedForClient", LOG_LEVEL_TRACE);
+  // send the queued packets of all peers in as few datagrams as possible
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    if ((*it)->host != nullptr) {
+      enet_host_flush((*it)->host);
+    }
 
-  auto listener = clientByGameId(listenerId);
-  auto speaker = clientByGameId(speakerId);
-  if (listener == nullptr || speaker == nullptr) {
-    logMessage("Unable to find client " + std::to_string(speakerId) + " for voice range", LOG_LEVEL_WARNING);
-    return false;
+    (*it)->mutex.unlock();
   }
-
-  return listener->isMutedClient(speaker);
-}
-
-void Server::registerClientConnectingCallback(ClientConnectingCallback_t callback) {
-  _clientConnectingCallback = callback;
 }
 
-void Server::registerClientConnectedCallback(ClientCallback_t callback) {
-  _clientConnectedCallback = callback;
-}
+void Server::addDirtyClient(Client *client, linalg::aliases::float3 previousPosition, int32_t previousDimension) {
+  dirtyClient_t dirtyClient;
+  dirtyClient.client = client;
+  dirtyClient.previousPosition = previousPosition;
+  dirtyClient.previousDimension = previousDimension;
 
-void Server::registerClientRejectedCallback(ClientRejectedCallback_t callback) {
-  _clientRejectedCallback = callback;
+  _dirtyClients.push_back(dirtyClient);
 }
 
-void Server::registerClientDisconnectedCallback(ClientCallback_t callback) {
-  _clientDisconnectedCallback = callback;
-}
+void Server::updateClientDimension(const std::shared_ptr<Client> &client, int32_t dimension) {
+  bool clean = client->positionChanged() == false;
+  auto previousDimension = client->dimension();
 
-void Server::registerClientTalkingChangedCallback(ClientStatusCallback_t callback) {
-  _clientTalkingChangedCallback = callback;
-}
+  client->setDimension(dimension);
 
-void Server::registerClientSpeakersMuteChangedCallback(ClientStatusCallback_t callback) {
-  _clientSpeakersMuteChangedCallback = callback;
-}
+  // clients of different dimensions never share a cell
+  _spatialGrid.updateClient(client);
 
-void Server::registerClientMicrophoneMuteChangedCallback(ClientStatusCallback_t callback) {
-  _clientMicrophoneMuteChangedCallback = callback;
+  if (clean && client->positionChanged()) {
+    addDirtyClient(client.get(), client->position(), previousDimension);
+  }
 }
 
-void Server::update() {
-  ENetEvent event;
+void Server::setClientChanged(Client *client) {
+  if (client->positionChanged()) {
+    return;
+  }
 
-  while (_running) {
-    std::unique_lock<std::mutex> guard(_serverMutex);
-    if (_server == nullptr) {
-      return;
-    }
+  client->setPositionChanged();
+  addDirtyClient(client, client->position(), client->dimension());
+}
 
-    int code = enet_host_service(_server, &event, 1);
+void Server::disconnectClient(std::shared_ptr<Client> client) {
+  auto shard = shardByHost(client->host());
 
-    guard.unlock();
+  if (shard == nullptr) {
+    client->disconnect();
+    return;
+  }
 
-    if (code > 0) {
-      switch (event.type) {
-        case ENET_EVENT_TYPE_CONNECT:
-          onClientConnect(event);
-          break;
+  // the network thread must not service the host while the peer is reset
+  std::lock_guard<std::mutex> guard(shard->mutex);
 
-        case ENET_EVENT_TYPE_DISCONNECT:
-          onClientDisconnect(event);
-          break;
+  // reset peers don't report a disconnect event
+  ENetPeer *peer = client->peer();
+  if (peer != nullptr) {
+    releasePeer(shard, peerIndex(peer));
+  }
 
-        case ENET_EVENT_TYPE_RECEIVE:
-          onClientMessage(event);
-          break;
+  client->disconnect();
+}
 
-        default:
-          break;
-      }
-    } else if (code < 0) {
-      logMessage("Network error: " + std::to_string(code), LOG_LEVEL_ERROR);
+void Server::removeDirtyClient(Client *client) {
+  auto it = _dirtyClients.begin();
+  while (it != _dirtyClients.end()) {
+    if ((*it).client == client) {
+      it = _dirtyClients.erase(it);
+    } else {
+      it++;
     }
   }
-
-  logMessage("Update thread stopped", LOG_LEVEL_DEBUG);
 }
 
-void Server::updateClients() {
-  while (_running) {
-    // logMessage("Locking in updateClients", LOG_LEVEL_TRACE);
-    std::unique_lock<std::mutex> guard(_clientsMutex);
-    // logMessage("Locked in updateClients", LOG_LEVEL_TRACE);
-
-    // calculate update for clients
-    for (auto it = _clients.begin(); it != _clients.end(); it++) {
-      // calculate update packet for this client
-      auto client = *it;
-      if (client == nullptr) {
-        continue;
-      }
-
-      if (client->isConnected() == false) {
-        logMessage("Client is not connected but in list", LOG_LEVEL_WARNING);
-        continue;
-      }
-
-      for (auto clientIt = _clients.begin(); clientIt != _clients.end(); clientIt++) {
-        // client to be heard
-        auto audibleClient = *clientIt;
-        if (audibleClient == nullptr || audibleClient == client) {
-          continue;
-        }
+void Server::publishSnapshot() {
+  clientSnapshot_t *snapshot = _snapshots.edit();
+  if (snapshot == nullptr) {
+    // readers still hold all other snapshots, publish on the next tick
+    return;
+  }
 
-        if (client->positionChanged() == false && audibleClient->positionChanged() == false) {
-          continue;
-        }
+  snapshot->numberOfClients = (int)_clients.size();
+  snapshot->connectedClients.clear();
+  snapshot->mutedClients.clear();
+  snapshot->mutedClientPairs.clear();
 
-        if (linalg::distance(audibleClient->position(), client->position()) < audibleClient->voiceRange()) {
-          client->addAudibleClient(audibleClient);
-        } else {
-          client->removeAudibleClient(audibleClient);
-        }
-      }
+  for (auto it = _clients.begin(); it != _clients.end(); it++) {
+    if (*it == nullptr) {
+      continue;
+    }
 
-      // create update packet
-      client->sendUpdate();
+    snapshot->connectedClients.set((*it)->gameId());
 
-      // send positions after audible list was updated
-      client->sendPositions();
+    if ((*it)->isMuted()) {
+      snapshot->mutedClients.set((*it)->gameId());
     }
 
-    // reset all position flags
-    for (auto it = _clients.begin(); it != _clients.end(); it++) {
-      if (*it == nullptr) {
-        continue;
-      }
+    auto mutedClients = (*it)->mutedClients(_slotClients);
 
-      (*it)->resetPositionChanged(); 
+    for (auto mutedIt = mutedClients.begin(); mutedIt != mutedClients.end(); mutedIt++) {
+      snapshot->mutedClientPairs.push_back(((uint32_t)(*it)->gameId() << 16) | (*mutedIt)->gameId());
     }
+  }
 
-    guard.unlock();
+  std::sort(snapshot->mutedClientPairs.begin(), snapshot->mutedClientPairs.end());
 
-    // wait for next update
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-  }
+  _snapshots.publish(snapshot);
 }
 
 void Server::abortThreads() {
   _running = false;
 
-  if (_thread != nullptr) {
-    if (_thread->joinable()) {
-      _thread->join();
-    }
+  // don't let the network threads wait for their timeout
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    wakeNetwork((*it).get());
+  }
+
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    if ((*it)->thread != nullptr) {
+      if ((*it)->thread->joinable()) {
+        (*it)->thread->join();
+      }
 
-    _thread = nullptr;
+      (*it)->thread = nullptr;
+    }
   }
 
   if (_clientUpdateThread != nullptr) {
@@ -583,46 +1919,183 @@ void Server::abortThreads() {
   }
 }
 
-std::shared_ptr<Client> Server::clientByGameId(uint16_t gameId) const {
+void Server::updateSpatialGridCellSize() {
+  // cells have to cover the biggest exit range to find every audible client in the surrounding cells
+  float maxVoiceRange = 0;
+
   for (auto it = _clients.begin(); it != _clients.end(); it++) {
     if (*it == nullptr) {
       continue;
     }
 
-    if ((*it)->gameId() == gameId) {
-      return *it;
+    if ((*it)->voiceRange() > maxVoiceRange) {
+      maxVoiceRange = (*it)->voiceRange();
     }
   }
 
-  return nullptr;
+  float cellSize = _spatialGrid.cellSize();
+  _spatialGrid.setCellSize(maxVoiceRange * _audibleExitFactor);
+
+  // surrounding cells changed, every client has to be recalculated
+  if (_spatialGrid.cellSize() != cellSize) {
+    _fullUpdate = true;
+  }
+}
+
+const std::shared_ptr<Client> &Server::clientByGameId(uint16_t gameId) const {
+  static const std::shared_ptr<Client> noClient;
+
+  auto it = _gameIdClients.find(gameId);
+  if (it == _gameIdClients.end()) {
+    return noClient;
+  }
+
+  return it->second;
 }
 
 std::shared_ptr<Client> Server::clientByTeamspeakId(uint16_t teamspeakId) const {
+  auto it = _teamspeakIdClients.find(teamspeakId);
+  if (it == _teamspeakIdClients.end()) {
+    return nullptr;
+  }
+
+  return it->second;
+}
+
+std::shared_ptr<Client> Server::clientByPeer(ENetPeer *peer) const {
+  if (peer == nullptr || peer->data == nullptr) {
+    return nullptr;
+  }
+
+  // peers point back to their client
+  auto client = clientByGameId(static_cast<Client *>(peer->data)->gameId());
+  if (client != nullptr && client->isPeer(peer)) {
+    return client;
+  }
+
+  // clients sharing a game id are not in the lookup table
   for (auto it = _clients.begin(); it != _clients.end(); it++) {
-    if (*it == nullptr) {
-      continue;
+    if (*it != nullptr && (*it)->isPeer(peer)) {
+      return *it;
     }
+  }
 
-    if ((*it)->teamspeakId() == teamspeakId) {
-      return *it;
+  return nullptr;
+}
+
+Server::networkShard_t *Server::shardByPeer(ENetPeer *peer) const {
+  return shardByHost(peer->host);
+}
+
+Server::networkShard_t *Server::shardByHost(ENetHost *host) const {
+  for (auto it = _shards.begin(); it != _shards.end(); it++) {
+    if ((*it)->host == host) {
+      return (*it).get();
     }
   }
 
   return nullptr;
 }
 
-std::shared_ptr<Client> Server::clientByPeer(ENetPeer *peer) const {
+size_t Server::peerIndex(ENetPeer *peer) const {
+  // peers are allocated once per host in one array
+  return (size_t)(peer - peer->host->peers);
+}
+
+void Server::cleanupClientReferences(std::shared_ptr<Client> client) {
+  // only clients knowing the removed client have to forget it
+  auto referencingClients = client->referencingClients(_slotClients);
+
+  for (auto it = referencingClients.begin(); it != referencingClients.end(); it++) {
+    if (*it == client.get()) {
+      continue;
+    }
+
+    (*it)->cleanupKnownClient(client.get());
+  }
+
+  // the slot of the removed client will be reused, so drop its references as well
+  auto referencedClients = client->referencedClients(_slotClients);
+
+  for (auto it = referencedClients.begin(); it != referencedClients.end(); it++) {
+    (*it)->removeReferencingClient(client->slot());
+  }
+}
+
+void Server::addClientLookup(std::shared_ptr<Client> client) {
+  // reuse slots of removed clients to keep the client sets small
+  uint32_t slot;
+
+  if (_freeSlots.empty()) {
+    slot = (uint32_t)_slotClients.size();
+    _slotClients.push_back(nullptr);
+    _slotGenerations.push_back(0);
+  } else {
+    slot = _freeSlots.back();
+    _freeSlots.pop_back();
+  }
+
+  client->setHandle(makeClientHandle(slot, _slotGenerations[slot]));
+  _slotClients[slot] = client.get();
+
+  addIdLookup(client);
+}
+
+bool Server::isValidPosition(linalg::aliases::float3 position, float rotation) {
+  // nan fails every comparison
+  return fabs(position.x) <= SERVER_MAX_POSITION_COORDINATE && fabs(position.y) <= SERVER_MAX_POSITION_COORDINATE && fabs(position.z) <= SERVER_MAX_POSITION_COORDINATE && isfinite(rotation);
+}
+
+bool Server::isGameIdConnected(uint16_t gameId) const {
+  // setters and queries check the same snapshot
+  const clientSnapshot_t *snapshot = _snapshots.acquire();
+  bool connected = snapshot->connectedClients.test(gameId);
+  _snapshots.release(snapshot);
+
+  return connected;
+}
+
+void Server::addIdLookup(std::shared_ptr<Client> client) {
+  // the first client of an id keeps the slot like the list order did before
+  if (_gameIdClients.find(client->gameId()) == _gameIdClients.end()) {
+    _gameIdClients[client->gameId()] = client;
+  }
+
+  if (_teamspeakIdClients.find(client->teamspeakId()) == _teamspeakIdClients.end()) {
+    _teamspeakIdClients[client->teamspeakId()] = client;
+  }
+}
+
+void Server::removeClientLookup(std::shared_ptr<Client> client) {
+  // every reference to the slot was cleaned up before
+  if (client->slot() < _slotClients.size() && _slotClients[client->slot()] == client.get()) {
+    _slotClients[client->slot()] = nullptr;
+    _freeSlots.push_back(client->slot());
+
+    // outdated handles of the slot don't resolve anymore
+    _slotGenerations[client->slot()]++;
+  }
+
+  auto gameIdIt = _gameIdClients.find(client->gameId());
+  if (gameIdIt != _gameIdClients.end() && gameIdIt->second == client) {
+    _gameIdClients.erase(gameIdIt);
+  }
+
+  auto teamspeakIt = _teamspeakIdClients.find(client->teamspeakId());
+  if (teamspeakIt != _teamspeakIdClients.end() && teamspeakIt->second == client) {
+    _teamspeakIdClients.erase(teamspeakIt);
+  }
+
+  // hand the slots over to remaining clients with the same ids
   for (auto it = _clients.begin(); it != _clients.end(); it++) {
-    if (*it == nullptr) {
+    if (*it == nullptr || *it == client) {
       continue;
     }
 
-    if ((*it)->isPeer(peer)) {
-      return *it;
+    if ((*it)->gameId() == client->gameId() || (*it)->teamspeakId() == client->teamspeakId()) {
+      addIdLookup(*it);
     }
   }
-
-  return nullptr;
 }
 
 void Server::onClientConnect(ENetEvent &event) {
@@ -631,6 +2104,48 @@ void Server::onClientConnect(ENetEvent &event) {
   enet_address_get_host_ip(&(event.peer->address), ip, 20);
 
   logMessage(std::string("New client connected ") + ip + ":" + std::to_string(event.peer->address.port), LOG_LEVEL_INFO);
+
+  auto shard = shardByPeer(event.peer);
+
+  std::unique_lock<std::mutex> guard(shard->mutex);
+
+  // reused peers have to negotiate their protocol again
+  shard->peerQuantizedPositions[peerIndex(event.peer)] = false;
+  bool reserved = reservePeer(shard, peerIndex(event.peer));
+
+  guard.unlock();
+
+  if (reserved == false) {
+    logMessage("Server is full, rejecting client", LOG_LEVEL_WARNING);
+    disconnectPeer(event.peer, DISCONNECT_STATUS_REJECTED);
+  }
+}
+
+bool Server::reservePeer(networkShard_t *shard, size_t index) {
+  if (shard->peerReserved[index]) {
+    return true;
+  }
+
+  // hosts of all shards share the client limit, a slot is taken before the peer is accepted
+  int peers = _reservedPeers.load();
+
+  do {
+    if (peers >= _maxClients) {
+      return false;
+    }
+  } while (_reservedPeers.compare_exchange_weak(peers, peers + 1) == false);
+
+  shard->peerReserved[index] = true;
+  return true;
+}
+
+void Server::releasePeer(networkShard_t *shard, size_t index) {
+  if (shard->peerReserved[index] == false) {
+    return;
+  }
+
+  shard->peerReserved[index] = false;
+  _reservedPeers--;
 }
 
 void Server::onClientDisconnect(ENetEvent &event) {
@@ -640,6 +2155,13 @@ void Server::onClientDisconnect(ENetEvent &event) {
 
   logMessage(std::string("Client disconnected ") + ip + ":" + std::to_string(event.peer->address.port), LOG_LEVEL_INFO);
 
+  auto shard = shardByPeer(event.peer);
+
+  // the slot of the peer is free for the next connection
+  shard->mutex.lock();
+  releasePeer(shard, peerIndex(event.peer));
+  shard->mutex.unlock();
+
   // remove client from list
   logMessage("Locking in onClientDisconnect", LOG_LEVEL_TRACE);
   std::lock_guard<std::mutex> guard(_clientsMutex);
@@ -648,12 +2170,14 @@ void Server::onClientDisconnect(ENetEvent &event) {
   // remove client in other's references
   auto client = clientByPeer(event.peer);
   if (client != nullptr) {
-    for (auto it = _clients.begin(); it != _clients.end(); it++) {
-      if (*it == client) {
-        continue;
-      }
+    cleanupClientReferences(client);
+
+    _spatialGrid.removeClient(client);
+    removeDirtyClient(client.get());
 
-      (*it)->cleanupKnownClient(client);
+    // limited listeners around the client have to select their audible clients again
+    if (_audibleClientLimit > 0) {
+      addDirtyClient(nullptr, client->position(), client->dimension());
     }
   } else {
     logMessage("Client not found for peer on disconnect", LOG_LEVEL_WARNING);
@@ -681,6 +2205,18 @@ void Server::onClientDisconnect(ENetEvent &event) {
     }
   }
 
+  if (client != nullptr) {
+    removeClientLookup(client);
+  }
+
+  // peer will be reused for new connections
+  event.peer->data = nullptr;
+
+  updateSpatialGridCellSize();
+
+  // the game must not address the client anymore once it is gone
+  publishSnapshot();
+
   logMessage("Client removed on disconnect", LOG_LEVEL_DEBUG);
 }
 
@@ -716,6 +2252,11 @@ void Server::onClientMessage(ENetEvent &event) {
       bool speakersChanged;
 
       if (client->handleStatus(event.packet, &talkingChanged, &microphoneChanged, &speakersChanged)) {
+        // talking clients are preferred by limited listeners around them
+        if (talkingChanged && _audibleClientLimit > 0 && _audibleClientLimitTalking) {
+          setClientChanged(client.get());
+        }
+
         // status changed, call callbacks
         if (talkingChanged && _clientTalkingChangedCallback != nullptr) {
           logMessage("Calling talking callback", LOG_LEVEL_TRACE);
@@ -737,6 +2278,11 @@ void Server::onClientMessage(ENetEvent &event) {
       }
       break;
 
+    case NETWORK_POSITION_CHANNEL:
+      // clients of the quantized protocol acknowledge keyframes
+      client->handlePositionAck(event.packet);
+      break;
+
     default:
       logMessage("Unhandled message received", LOG_LEVEL_WARNING);
       break;
@@ -748,20 +2294,14 @@ void Server::onClientMessage(ENetEvent &event) {
 void Server::handleProtocolMessage(ENetEvent &event) {
   protocolPacket_t protocolPacket;
 
-  std::string data((char *)event.packet->data, event.packet->dataLength);
-  std::istringstream is(data);
-
-  try {
-    cereal::BinaryInputArchive archive(is);
-    archive(protocolPacket);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
+  if (parsePacket(event.packet, &protocolPacket) == false) {
+    logMessage("Invalid protocol packet of " + std::to_string(event.packet->dataLength) + " bytes", LOG_LEVEL_WARNING);
     return;
   }
 
   // compare protocol versions
   bool clientMatches = verifyProtocolVersion(protocolPacket.versionMajor, protocolPacket.versionMinor, PROTOCOL_MIN_VERSION_MAJOR, PROTOCOL_MIN_VERSION_MINOR);
-  bool serverMatches = verifyProtocolVersion(PROTOCOL_VERSION_MAJOR, PROTOCOL_VERSION_MINOR, protocolPacket.minimumVersionMajor, protocolPacket.minimumVersionMinor);
+  bool serverMatches = verifyProtocolVersion(PROTOCOL_QUANTIZED_POSITIONS_VERSION_MAJOR, PROTOCOL_QUANTIZED_POSITIONS_VERSION_MINOR, protocolPacket.minimumVersionMajor, protocolPacket.minimumVersionMinor);
 
   if (clientMatches == false || serverMatches == false) {
     int disconnectStatus;
@@ -776,33 +2316,35 @@ void Server::handleProtocolMessage(ENetEvent &event) {
       disconnectStatus = DISCONNECT_STATUS_OUTDATED_SERVER;
     }
 
-    sendProtocolResponse(event.peer, STATUS_CODE_OUTDATED_PROTOCOL_VERSION);
+    sendProtocolResponse(event.peer, STATUS_CODE_OUTDATED_PROTOCOL_VERSION, PROTOCOL_VERSION_MAJOR, PROTOCOL_VERSION_MINOR);
 
-    enet_peer_disconnect_later(event.peer, disconnectStatus);
+    disconnectPeerLater(event.peer, disconnectStatus);
     return;
   }
 
-  sendProtocolResponse(event.peer, STATUS_CODE_OK);
+  // clients knowing the quantized revision get it confirmed, older ones keep the float positions
+  bool quantizedPositions = verifyProtocolVersion(protocolPacket.versionMajor, protocolPacket.versionMinor, PROTOCOL_QUANTIZED_POSITIONS_VERSION_MAJOR, PROTOCOL_QUANTIZED_POSITIONS_VERSION_MINOR);
+  shardByPeer(event.peer)->peerQuantizedPositions[peerIndex(event.peer)] = quantizedPositions;
+
+  if (quantizedPositions) {
+    sendProtocolResponse(event.peer, STATUS_CODE_OK, PROTOCOL_QUANTIZED_POSITIONS_VERSION_MAJOR, PROTOCOL_QUANTIZED_POSITIONS_VERSION_MINOR);
+  } else {
+    sendProtocolResponse(event.peer, STATUS_CODE_OK, PROTOCOL_VERSION_MAJOR, PROTOCOL_VERSION_MINOR);
+  }
 }
 
 void Server::handleHandshake(ENetEvent &event) {
   handshakePacket_t handshakePacket;
 
-  std::string data((char *)event.packet->data, event.packet->dataLength);
-  std::istringstream is(data);
-
-  try {
-    cereal::BinaryInputArchive archive(is);
-    archive(handshakePacket);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
+  if (parsePacket(event.packet, &handshakePacket) == false) {
+    logMessage("Invalid handshake packet of " + std::to_string(event.packet->dataLength) + " bytes", LOG_LEVEL_WARNING);
     return;
   }
 
   if (handshakePacket.statusCode != STATUS_CODE_OK) {
     logMessage("Handshake error: " + std::to_string(handshakePacket.statusCode), LOG_LEVEL_INFO);
 
-    enet_peer_disconnect(event.peer, 0);
+    disconnectPeer(event.peer, 0);
 
     if (_clientRejectedCallback != nullptr) {
       logMessage("Calling rejected callback", LOG_LEVEL_TRACE);
@@ -834,7 +2376,7 @@ void Server::handleHandshake(ENetEvent &event) {
     if (_clientConnectingCallback != nullptr) {
       std::future<bool> result = std::async(_clientConnectingCallback, handshakePacket.gameId, handshakePacket.teamspeakClientUniqueIdentity.c_str());
       if (result.get() == false) {
-        enet_peer_disconnect(event.peer, DISCONNECT_STATUS_REJECTED);
+        disconnectPeer(event.peer, DISCONNECT_STATUS_REJECTED);
         return;
       }
     }
@@ -846,7 +2388,16 @@ void Server::handleHandshake(ENetEvent &event) {
     logMessage("Locked in handleHandshake", LOG_LEVEL_TRACE);
 
     client = std::make_shared<Client>(event.peer, handshakePacket.gameId, handshakePacket.teamspeakId);
+    client->setQuantizedPositions(shardByPeer(event.peer)->peerQuantizedPositions[peerIndex(event.peer)]);
     _clients.push_back(client);
+    addClientLookup(client);
+
+    _spatialGrid.insertClient(client);
+    addDirtyClient(client.get(), client->position(), client->dimension());
+    updateSpatialGridCellSize();
+
+    // the connected callback may address the client right away
+    publishSnapshot();
 
     guard.unlock();
 
@@ -868,44 +2419,39 @@ void Server::sendHandshakeResponse(ENetPeer *peer, int statusCode, std::string r
   packet.channelId = _teamspeakChannelId;
   packet.channelPassword = _teamspeakChannelPassword;
 
-  // serialize packet
-  std::ostringstream os;
-
-  try {
-    cereal::BinaryOutputArchive archive(os);
-    archive(packet);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
-    return;
-  }
-
-  // send packet
-  auto data = os.str();
-
-  ENetPacket *rawPacket = enet_packet_create(data.c_str(), data.size(), ENET_PACKET_FLAG_RELIABLE);
-  enet_peer_send(peer, NETWORK_HANDSHAKE_CHANNEL, rawPacket);
+  sendPeerPacket(peer, createPacket(packet, ENET_PACKET_FLAG_RELIABLE), NETWORK_HANDSHAKE_CHANNEL);
 }
 
-void Server::sendProtocolResponse(ENetPeer *peer, int statusCode) {
+void Server::sendProtocolResponse(ENetPeer *peer, int statusCode, uint16_t versionMajor, uint16_t versionMinor) {
   protocolResponsePacket_t packet;
   packet.statusCode = statusCode;
-  packet.versionMajor = PROTOCOL_VERSION_MAJOR;
-  packet.versionMinor = PROTOCOL_VERSION_MINOR;
+  packet.versionMajor = versionMajor;
+  packet.versionMinor = versionMinor;
 
-  // serialize packet
-  std::ostringstream os;
+  sendPeerPacket(peer, createPacket(packet, ENET_PACKET_FLAG_RELIABLE), NETWORK_PROTOCOL_CHANNEL);
+}
 
-  try {
-    cereal::BinaryOutputArchive archive(os);
-    archive(packet);
-  } catch (std::exception &e) {
-    logMessage(e.what(), LOG_LEVEL_ERROR);
+void Server::sendPeerPacket(ENetPeer *peer, ENetPacket *packet, int channel) {
+  if (packet == nullptr) {
     return;
   }
 
-  // send packet
-  auto data = os.str();
+  // the update thread queues packets for peers of the same host
+  std::lock_guard<std::mutex> guard(shardByPeer(peer)->mutex);
+
+  // packets which were not queued are not freed by enet
+  if (enet_peer_send(peer, (enet_uint8)channel, packet) != 0 && packet->referenceCount == 0) {
+    enet_packet_destroy(packet);
+  }
+}
+
+void Server::disconnectPeer(ENetPeer *peer, enet_uint32 data) {
+  std::lock_guard<std::mutex> guard(shardByPeer(peer)->mutex);
+  enet_peer_disconnect(peer, data);
+}
 
-  ENetPacket *rawPacket = enet_packet_create(data.c_str(), data.size(), ENET_PACKET_FLAG_RELIABLE);
-  enet_peer_send(peer, NETWORK_PROTOCOL_CHANNEL, rawPacket);
+void Server::disconnectPeerLater(ENetPeer *peer, enet_uint32 data) {
+  // queued responses are sent before the disconnect
+  std::lock_guard<std::mutex> guard(shardByPeer(peer)->mutex);
+  enet_peer_disconnect_later(peer, data);
 }
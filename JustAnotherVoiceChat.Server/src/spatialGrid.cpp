@@ -0,0 +1,226 @@
+/*
+ * File: src/spatialGrid.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "spatialGrid.h"
+
+#include "client.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+using namespace justAnotherVoiceChat;
+
+SpatialGrid::SpatialGrid(float cellSize) {
+  _cellSize = 1;
+
+  setCellSize(cellSize);
+}
+
+SpatialGrid::~SpatialGrid() {
+  clear();
+}
+
+void SpatialGrid::setCellSize(float cellSize) {
+  // cells smaller than a unit would only produce huge amounts of empty cells
+  if (cellSize < 1) {
+    cellSize = 1;
+  }
+
+  if (cellSize == _cellSize) {
+    return;
+  }
+
+  _cellSize = cellSize;
+
+  // sort every client into the cell matching the new size
+  std::vector<std::shared_ptr<Client>> clients;
+
+  for (auto it = _cells.begin(); it != _cells.end(); it++) {
+    clients.insert(clients.end(), it->second.begin(), it->second.end());
+  }
+
+  clear();
+
+  for (auto it = clients.begin(); it != clients.end(); it++) {
+    insertClient(*it);
+  }
+}
+
+float SpatialGrid::cellSize() const {
+  return _cellSize;
+}
+
+void SpatialGrid::insertClient(const std::shared_ptr<Client> &client) {
+  if (client == nullptr) {
+    return;
+  }
+
+  if (_clientCells.find(client.get()) != _clientCells.end()) {
+    updateClient(client);
+    return;
+  }
+
+  auto key = cellKey(client->position(), client->dimension());
+
+  _cells[key].push_back(client);
+  _clientCells[client.get()] = key;
+}
+
+void SpatialGrid::updateClient(const std::shared_ptr<Client> &client) {
+  if (client == nullptr) {
+    return;
+  }
+
+  auto clientCell = _clientCells.find(client.get());
+  if (clientCell == _clientCells.end()) {
+    insertClient(client);
+    return;
+  }
+
+  auto key = cellKey(client->position(), client->dimension());
+  if (key == clientCell->second) {
+    return;
+  }
+
+  // move client into new cell
+  removeClient(client);
+
+  _cells[key].push_back(client);
+  _clientCells[client.get()] = key;
+}
+
+void SpatialGrid::removeClient(const std::shared_ptr<Client> &client) {
+  auto clientCell = _clientCells.find(client.get());
+  if (clientCell == _clientCells.end()) {
+    return;
+  }
+
+  auto cell = _cells.find(clientCell->second);
+  if (cell != _cells.end()) {
+    auto it = cell->second.begin();
+    while (it != cell->second.end()) {
+      if (*it == client) {
+        it = cell->second.erase(it);
+      } else {
+        it++;
+      }
+    }
+
+    if (cell->second.empty()) {
+      _cells.erase(cell);
+    }
+  }
+
+  _clientCells.erase(clientCell);
+}
+
+void SpatialGrid::clear() {
+  _cells.clear();
+  _clientCells.clear();
+}
+
+const std::unordered_map<uint64_t, SpatialGrid::cell_t> &SpatialGrid::cells() const {
+  return _cells;
+}
+
+void SpatialGrid::neighbourCellKeys(linalg::aliases::float3 position, int32_t dimension, uint64_t *cellKeys) const {
+  int32_t x = cellCoordinate(position.x);
+  int32_t y = cellCoordinate(position.y);
+  uint16_t hash = dimensionHash(dimension);
+
+  // cells are at least as big as the biggest voice range, so every client in range is in one of the surrounding cells
+  int index = 0;
+
+  for (int32_t offsetX = -1; offsetX <= 1; offsetX++) {
+    for (int32_t offsetY = -1; offsetY <= 1; offsetY++) {
+      cellKeys[index++] = cellKey(x + offsetX, y + offsetY, hash);
+    }
+  }
+}
+
+void SpatialGrid::halfNeighbourCellKeys(uint64_t cellKey, uint64_t *cellKeys) const {
+  int32_t x = (int32_t)((cellKey >> 40) & 0xFFFFFF);
+  int32_t y = (int32_t)((cellKey >> 16) & 0xFFFFFF);
+  uint16_t hash = (uint16_t)(cellKey & 0xFFFF);
+
+  // the cell itself and the forward half of its surrounding cells, so every pair of cells is visited only once
+  cellKeys[0] = cellKey;
+  cellKeys[1] = this->cellKey(x + 1, y, hash);
+  cellKeys[2] = this->cellKey(x - 1, y + 1, hash);
+  cellKeys[3] = this->cellKey(x, y + 1, hash);
+  cellKeys[4] = this->cellKey(x + 1, y + 1, hash);
+}
+
+void SpatialGrid::neighbourClients(linalg::aliases::float3 position, int32_t dimension, std::vector<std::shared_ptr<Client>> &clients) const {
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  neighbourCellKeys(position, dimension, cellKeys);
+
+  for (int i = 0; i < SPATIAL_GRID_NEIGHBOUR_CELLS; i++) {
+    auto cell = _cells.find(cellKeys[i]);
+    if (cell == _cells.end()) {
+      continue;
+    }
+
+    clients.insert(clients.end(), cell->second.begin(), cell->second.end());
+  }
+}
+
+bool SpatialGrid::isNeighbour(linalg::aliases::float3 position, int32_t dimension, linalg::aliases::float3 otherPosition, int32_t otherDimension) const {
+  return dimension == otherDimension && abs(cellCoordinate(position.x) - cellCoordinate(otherPosition.x)) <= 1 && abs(cellCoordinate(position.y) - cellCoordinate(otherPosition.y)) <= 1;
+}
+
+int32_t SpatialGrid::cellCoordinate(float value) const {
+  double coordinate = floor((double)value / _cellSize);
+
+  // casting nan or values out of range is undefined
+  if (coordinate != coordinate) {
+    return 0;
+  }
+
+  if (coordinate < -SPATIAL_GRID_MAX_CELL_COORDINATE) {
+    return -SPATIAL_GRID_MAX_CELL_COORDINATE;
+  } else if (coordinate > SPATIAL_GRID_MAX_CELL_COORDINATE) {
+    return SPATIAL_GRID_MAX_CELL_COORDINATE;
+  }
+
+  return (int32_t)coordinate;
+}
+
+uint64_t SpatialGrid::cellKey(int32_t x, int32_t y, uint16_t dimension) const {
+  // wrapped coordinates or equal dimension hashes only share a cell, clients are still compared by their dimension
+  return ((uint64_t)((uint32_t)x & 0xFFFFFF) << 40) | ((uint64_t)((uint32_t)y & 0xFFFFFF) << 16) | dimension;
+}
+
+uint64_t SpatialGrid::cellKey(linalg::aliases::float3 position, int32_t dimension) const {
+  return cellKey(cellCoordinate(position.x), cellCoordinate(position.y), dimensionHash(dimension));
+}
+
+uint16_t SpatialGrid::dimensionHash(int32_t dimension) const {
+  uint32_t value = (uint32_t)dimension;
+  return (uint16_t)(value ^ (value >> 16));
+}
@@ -0,0 +1,141 @@
+/*
+ * File: src/workerPool.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "workerPool.h"
+
+using namespace justAnotherVoiceChat;
+
+WorkerPool::WorkerPool() {
+  _task = nullptr;
+  _count = 0;
+  _pendingWorkers = 0;
+  _generation = 0;
+  _running = false;
+}
+
+WorkerPool::~WorkerPool() {
+  stopThreads();
+}
+
+void WorkerPool::setThreadCount(size_t threadCount) {
+  if (threadCount < 1) {
+    threadCount = 1;
+  }
+
+  if (threadCount == this->threadCount()) {
+    return;
+  }
+
+  stopThreads();
+
+  // the calling thread always works on the first slice
+  std::lock_guard<std::mutex> guard(_mutex);
+  _running = true;
+
+  for (size_t i = 1; i < threadCount; i++) {
+    _threads.push_back(std::make_shared<std::thread>(&WorkerPool::work, this, i, _generation));
+  }
+}
+
+size_t WorkerPool::threadCount() const {
+  return _threads.size() + 1;
+}
+
+void WorkerPool::run(size_t count, WorkerTask_t task) {
+  if (_threads.empty() || count < 2) {
+    task(0, 0, count);
+    return;
+  }
+
+  std::unique_lock<std::mutex> guard(_mutex);
+  _task = task;
+  _count = count;
+  _pendingWorkers = _threads.size();
+  _generation++;
+
+  guard.unlock();
+  _workCondition.notify_all();
+
+  runSlice(0);
+
+  // wait for all workers to finish their slice
+  guard.lock();
+  _doneCondition.wait(guard, [this] { return _pendingWorkers == 0; });
+
+  _task = nullptr;
+}
+
+void WorkerPool::work(size_t worker, uint64_t generation) {
+  while (true) {
+    std::unique_lock<std::mutex> guard(_mutex);
+    _workCondition.wait(guard, [this, generation] { return _running == false || _generation != generation; });
+
+    if (_running == false) {
+      return;
+    }
+
+    generation = _generation;
+    guard.unlock();
+
+    runSlice(worker);
+
+    guard.lock();
+    _pendingWorkers--;
+
+    if (_pendingWorkers == 0) {
+      _doneCondition.notify_one();
+    }
+  }
+}
+
+void WorkerPool::runSlice(size_t worker) {
+  // every worker owns a contiguous slice of the items
+  size_t threads = threadCount();
+  size_t begin = _count * worker / threads;
+  size_t end = _count * (worker + 1) / threads;
+
+  if (begin < end) {
+    _task(worker, begin, end);
+  }
+}
+
+void WorkerPool::stopThreads() {
+  std::unique_lock<std::mutex> guard(_mutex);
+  _running = false;
+  guard.unlock();
+
+  _workCondition.notify_all();
+
+  for (auto it = _threads.begin(); it != _threads.end(); it++) {
+    if ((*it)->joinable()) {
+      (*it)->join();
+    }
+  }
+
+  _threads.clear();
+}
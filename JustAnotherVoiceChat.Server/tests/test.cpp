@@ -40,6 +40,11 @@
 #include "../thirdparty/JustAnotherVoiceChat/include/protocol.h"
 
 #include "test_api.h"
+#include "test_positionTable.h"
+#include "test_spatialGrid.h"
+#include "test_packetWriter.h"
+#include "test_packetReader.h"
+#include "test_quantizedPositions.h"
 
 void clientConnectedCallback(uint16_t clientId) {
   std::cout << "[TEST] Client connected " << clientId << std::endl;
@@ -92,6 +97,26 @@ void signalHandler(int signum) {
 int main() {
   test_api();
 
+  if (test_positionTable() == false) {
+    return EXIT_FAILURE;
+  }
+
+  if (test_spatialGrid() == false) {
+    return EXIT_FAILURE;
+  }
+
+  if (test_packetWriter() == false) {
+    return EXIT_FAILURE;
+  }
+
+  if (test_packetReader() == false) {
+    return EXIT_FAILURE;
+  }
+
+  if (test_quantizedPositions() == false) {
+    return EXIT_FAILURE;
+  }
+
 #ifdef _WIN32
 
 #else
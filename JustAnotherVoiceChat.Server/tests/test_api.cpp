@@ -38,6 +38,9 @@ void test_api() {
   JV_StartServer();
   JV_IsServerRunning();
   JV_StopServer();
+  JV_DestroyServer();
+  JV_CreateServerWithMaxClients(ENET_PORT, "", 0, "", 1024);
+  JV_DestroyServer();
   JV_RegisterClientConnectedCallback(NULL);
   JV_UnregisterClientConnectedCallback();
   JV_RegisterClientDisconnectedCallback(NULL);
@@ -53,7 +56,23 @@ void test_api() {
   JV_RemoveClient(0);
   JV_RemoveAllClients();
   JV_SetClientPosition(0, 0, 0, 0, 0);
+  JV_SetClientDimension(0, 0);
+  JV_SetClientDimensions(NULL, 0);
   JV_Set3DSettings(0, 0);
+  JV_SetWorkerThreadCount(0);
+  JV_SetPairwiseEvaluation(false);
+  JV_SetAudibleRangeFactors(1, 1);
+  JV_SetTickRate(20);
+  JV_GetTickRate();
+  JV_GetTickOverrunCount();
+  JV_GetTickDuration();
+  JV_GetTickSendLatency();
+  JV_SetPositionLevelOfDetail(1, 1);
+  JV_SetPositionUpdateThreshold(0, 0, 20);
+  JV_SetAudibleClientLimit(0, false);
+  JV_SetNetworkShardCount(1);
+  JV_GetNetworkShardCount();
+  JV_GetClientPort(0);
   JV_SetRelativePositionForClient(0, 0, 0, 0, 0);
   JV_ResetRelativePositionForClient(0, 0);
   JV_ResetAllRelativePositions(0);
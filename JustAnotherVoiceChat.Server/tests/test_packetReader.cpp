@@ -0,0 +1,167 @@
+/*
+ * File: tests/test_packetReader.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_packetReader.h"
+
+#include "packetReader.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string.h>
+
+using namespace justAnotherVoiceChat;
+
+template<typename Packet>
+static std::string serialize(const Packet &packet) {
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive archive(os);
+    archive(packet);
+  }
+
+  return os.str();
+}
+
+template<typename Packet>
+static bool parse(const std::string &data, Packet *result) {
+  ENetPacket packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.data = (enet_uint8 *)data.data();
+  packet.dataLength = data.size();
+
+  return parsePacket(&packet, result);
+}
+
+template<typename Packet>
+static bool rejectTruncated(const std::string &data, std::string name) {
+  // every prefix of a valid packet misses at least one field
+  for (size_t length = 0; length < data.size(); length++) {
+    Packet result;
+
+    if (parse(data.substr(0, length), &result)) {
+      std::cerr << "[TEST] " << name << " truncated to " << length << " of " << data.size() << " bytes was accepted" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool testProtocolPacket() {
+  protocolPacket_t packet = { 1, 2, 3, 65535 };
+  auto data = serialize(packet);
+
+  protocolPacket_t result;
+  if (parse(data, &result) == false || result.versionMajor != 1 || result.versionMinor != 2 || result.minimumVersionMajor != 3 || result.minimumVersionMinor != 65535) {
+    std::cerr << "[TEST] Protocol packet does not match after reading" << std::endl;
+    return false;
+  }
+
+  return rejectTruncated<protocolPacket_t>(data, "Protocol packet");
+}
+
+static bool testHandshakePacket() {
+  handshakePacket_t packet;
+  packet.statusCode = STATUS_CODE_OK;
+  packet.gameId = 12;
+  packet.teamspeakId = 34;
+  packet.teamspeakClientUniqueIdentity = "a1b2c3=";
+
+  auto data = serialize(packet);
+
+  handshakePacket_t result;
+  if (parse(data, &result) == false || result.statusCode != STATUS_CODE_OK || result.gameId != 12 || result.teamspeakId != 34 || result.teamspeakClientUniqueIdentity != "a1b2c3=") {
+    std::cerr << "[TEST] Handshake packet does not match after reading" << std::endl;
+    return false;
+  }
+
+  packet.teamspeakClientUniqueIdentity = "";
+
+  if (parse(serialize(packet), &result) == false || result.teamspeakClientUniqueIdentity.empty() == false) {
+    std::cerr << "[TEST] Handshake packet with empty identity was not read" << std::endl;
+    return false;
+  }
+
+  // string size behind status code and ids claims more bytes than the packet has
+  std::string oversized = data;
+  oversized[sizeof(int) + 2 * sizeof(uint16_t) + 7] = (char)0x7f;
+
+  if (parse(oversized, &result)) {
+    std::cerr << "[TEST] Handshake packet with oversized identity was accepted" << std::endl;
+    return false;
+  }
+
+  return rejectTruncated<handshakePacket_t>(data, "Handshake packet");
+}
+
+static bool testStatusPacket() {
+  statusPacket_t packet = { true, false, true };
+  auto data = serialize(packet);
+
+  statusPacket_t result;
+  if (parse(data, &result) == false || result.talking == false || result.microphoneMuted || result.speakersMuted == false) {
+    std::cerr << "[TEST] Status packet does not match after reading" << std::endl;
+    return false;
+  }
+
+  // bytes other than 0 and 1 are read as true
+  data[1] = 2;
+
+  if (parse(data, &result) == false || result.microphoneMuted == false) {
+    std::cerr << "[TEST] Status packet with non boolean byte was not read as true" << std::endl;
+    return false;
+  }
+
+  return rejectTruncated<statusPacket_t>(data, "Status packet");
+}
+
+static bool testPositionAckPacket() {
+  uint32_t frame = 0x01020304;
+  std::string data((const char *)&frame, sizeof(frame));
+
+  positionAckPacket_t result;
+  if (parse(data, &result) == false || result.frame != frame) {
+    std::cerr << "[TEST] Position ack packet does not match after reading" << std::endl;
+    return false;
+  }
+
+  return rejectTruncated<positionAckPacket_t>(data, "Position ack packet");
+}
+
+bool test_packetReader() {
+  if (testProtocolPacket() == false || testHandshakePacket() == false || testStatusPacket() == false || testPositionAckPacket() == false) {
+    return false;
+  }
+
+  std::cout << "[TEST] Packet reader matches cereal" << std::endl;
+  return true;
+}
@@ -0,0 +1,180 @@
+/*
+ * File: tests/test_packetWriter.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_packetWriter.h"
+
+#include "packetWriter.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <string.h>
+
+using namespace justAnotherVoiceChat;
+
+template<typename Packet>
+static bool compareBytes(const Packet &packet, const std::string &expected, std::string name) {
+  size_t length = packetSize(packet);
+  if (length != expected.size()) {
+    std::cerr << "[TEST] Size of " << name << " is " << length << " instead of " << expected.size() << std::endl;
+    return false;
+  }
+
+  std::vector<uint8_t> data(length + 1);
+
+  PacketWriter writer(data.data(), length);
+  writePacket(writer, packet);
+
+  if (writer.overflowed() || writer.offset() != length) {
+    std::cerr << "[TEST] Writing " << name << " stopped at " << writer.offset() << " of " << length << " bytes" << std::endl;
+    return false;
+  }
+
+  if (memcmp(data.data(), expected.data(), length) != 0) {
+    std::cerr << "[TEST] Bytes of " << name << " differ from cereal" << std::endl;
+    return false;
+  }
+
+  // a buffer one byte too short must not be written past its end
+  if (length > 0) {
+    data[length - 1] = 0xAB;
+
+    PacketWriter shortWriter(data.data(), length - 1);
+    writePacket(shortWriter, packet);
+
+    if (shortWriter.overflowed() == false || data[length - 1] != 0xAB) {
+      std::cerr << "[TEST] Writing " << name << " into a short buffer did not overflow" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename Packet>
+static bool compareSerialization(const Packet &packet, std::string name) {
+  // cereal's output is the reference for the hand written layout
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive archive(os);
+    archive(packet);
+  }
+
+  return compareBytes(packet, os.str(), name);
+}
+
+static bool compareQuantizedSerialization(const quantizedPositionPacket_t &packet, std::string name) {
+  // the protocol 0.4 layout has no cereal type, build it field by field
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive archive(os);
+    archive(packet.frame, packet.baseFrame, packet.x, packet.y, packet.z, packet.rotation, (uint16_t)packet.positions.size());
+
+    for (auto it = packet.positions.begin(); it != packet.positions.end(); it++) {
+      archive((*it).teamspeakId, (*it).flags);
+
+      if (((*it).flags & POSITION_UPDATE_FLAG_FULL) != 0) {
+        archive((*it).x, (*it).y, (*it).z, (*it).voiceRange);
+      } else {
+        archive((int8_t)(*it).x, (int8_t)(*it).y, (int8_t)(*it).z);
+      }
+    }
+  }
+
+  return compareBytes(packet, os.str(), name);
+}
+
+bool test_packetWriter() {
+  protocolResponsePacket_t protocolResponse;
+  protocolResponse.statusCode = STATUS_CODE_OUTDATED_PROTOCOL_VERSION;
+  protocolResponse.versionMajor = 1;
+  protocolResponse.versionMinor = 513;
+
+  handshakeResponsePacket_t handshakeResponse;
+  handshakeResponse.statusCode = STATUS_CODE_OK;
+  handshakeResponse.reason = "Everything fine";
+  handshakeResponse.teamspeakServerUniqueIdentifier = "a1b2c3=";
+  handshakeResponse.channelId = 0x0102030405060708ULL;
+  handshakeResponse.channelPassword = "";
+
+  controlPacket_t control;
+  control.nickname = "Nickname";
+
+  updatePacket_t emptyUpdate;
+
+  updatePacket_t update;
+  update.audioUpdates.push_back({ 5, true });
+  update.audioUpdates.push_back({ 65535, false });
+  update.positionUpdates.push_back({ 7, 1.5f, -2.25f, 1e6f, 20 });
+
+  positionPacket_t position;
+  position.x = 10;
+  position.y = -20;
+  position.z = 0.125f;
+  position.rotation = 3.14f;
+
+  positionPacket_t emptyPosition = position;
+
+  for (uint16_t i = 0; i < 3; i++) {
+    position.positions.push_back({ i, i * 1.5f, i * -2.5f, 0, 15 });
+  }
+
+  quantizedPositionPacket_t quantizedPosition;
+  quantizedPosition.frame = 0x01020304;
+  quantizedPosition.baseFrame = 0x01020300;
+  quantizedPosition.x = 10;
+  quantizedPosition.y = -20;
+  quantizedPosition.z = 0.125f;
+  quantizedPosition.rotation = 3.14f;
+
+  quantizedPositionPacket_t emptyQuantizedPosition = quantizedPosition;
+
+  // full entries and deltas at both ends of the 8 bit range
+  quantizedPosition.positions.push_back({ 1, POSITION_UPDATE_FLAG_FULL, INT16_MIN, -1, INT16_MAX, 320 });
+  quantizedPosition.positions.push_back({ 2, 0, INT8_MIN, 0, INT8_MAX, 0 });
+  quantizedPosition.positions.push_back({ 65535, POSITION_UPDATE_FLAG_FULL, 256, -512, 0, UINT16_MAX });
+
+  if (compareSerialization(protocolResponse, "protocol response") == false ||
+      compareSerialization(handshakeResponse, "handshake response") == false ||
+      compareSerialization(control, "control packet") == false ||
+      compareSerialization(emptyUpdate, "empty update packet") == false ||
+      compareSerialization(update, "update packet") == false ||
+      compareSerialization(emptyPosition, "empty position packet") == false ||
+      compareSerialization(position, "position packet") == false ||
+      compareQuantizedSerialization(emptyQuantizedPosition, "empty quantized position packet") == false ||
+      compareQuantizedSerialization(quantizedPosition, "quantized position packet") == false) {
+    return false;
+  }
+
+  std::cout << "[TEST] Packet writer matches cereal" << std::endl;
+  return true;
+}
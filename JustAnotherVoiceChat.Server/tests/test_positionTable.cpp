@@ -0,0 +1,95 @@
+/*
+ * File: tests/test_positionTable.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "test_positionTable.h"
+
+#include "positionTable.h"
+#include "spatialGrid.h"
+#include "client.h"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <math.h>
+
+using namespace justAnotherVoiceChat;
+
+static bool compareDistances(const PositionTable &table, linalg::aliases::float3 position, size_t begin, size_t end) {
+  std::vector<float> distances(end - begin);
+  table.squaredDistances(position, begin, end, distances.data());
+
+  for (size_t i = begin; i < end; i++) {
+    // scalar reference for the vectorized kernel
+    linalg::aliases::float3 delta = table.position(i) - position;
+    float expected = delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+    float distance = distances[i - begin];
+
+    if (fabs(distance - expected) > expected * 1e-6f + 1e-6f) {
+      std::cerr << "[TEST] Squared distance " << i << " of " << begin << "-" << end << " is " << distance << " instead of " << expected << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool test_positionTable() {
+  // counts below and above the vector widths of 4 and 8 to cover the scalar tail
+  for (size_t count = 1; count <= 19; count++) {
+    SpatialGrid grid(1000);
+    std::vector<std::shared_ptr<Client>> clients;
+
+    for (size_t i = 0; i < count; i++) {
+      auto client = std::make_shared<Client>(nullptr, (uint16_t)i, (uint16_t)i);
+      client->setPosition(linalg::aliases::float3(i * 3.5f, 100 + i * 7.25f, i * 0.5f));
+
+      grid.insertClient(client);
+      clients.push_back(client);
+    }
+
+    PositionTable table;
+    table.build(grid, true);
+
+    if (table.size() != count || table.cellCount() != 1) {
+      std::cerr << "[TEST] Position table of " << count << " clients has " << table.size() << " entries in " << table.cellCount() << " cells" << std::endl;
+      return false;
+    }
+
+    linalg::aliases::float3 position(12.5f, -3, 40);
+
+    // unaligned ranges start in the middle of the table
+    for (size_t begin = 0; begin < count; begin++) {
+      if (compareDistances(table, position, begin, count) == false) {
+        return false;
+      }
+    }
+  }
+
+  std::cout << "[TEST] Position table distances match" << std::endl;
+  return true;
+}
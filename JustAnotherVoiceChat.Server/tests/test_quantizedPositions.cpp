@@ -0,0 +1,245 @@
+/*
+ * File: tests/test_quantizedPositions.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "test_quantizedPositions.h"
+
+#include "client.h"
+#include "packetWriter.h"
+
+#include <cereal/archives/binary.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace justAnotherVoiceChat;
+
+// reads the protocol 0.4 layout the way the client does
+static bool decode(const std::string &data, quantizedPositionPacket_t *packet) {
+  std::istringstream is(data);
+
+  try {
+    cereal::BinaryInputArchive archive(is);
+
+    uint16_t count;
+    archive(packet->frame, packet->baseFrame, packet->x, packet->y, packet->z, packet->rotation, count);
+
+    packet->positions.clear();
+
+    for (uint16_t i = 0; i < count; i++) {
+      quantizedPositionUpdate_t update = {};
+      archive(update.teamspeakId, update.flags);
+
+      if ((update.flags & POSITION_UPDATE_FLAG_FULL) != 0) {
+        archive(update.x, update.y, update.z, update.voiceRange);
+      } else {
+        int8_t x, y, z;
+        archive(x, y, z);
+
+        update.x = x;
+        update.y = y;
+        update.z = z;
+      }
+
+      packet->positions.push_back(update);
+    }
+  } catch (const std::exception &) {
+    return false;
+  }
+
+  // trailing bytes mean the layouts disagree
+  return is.peek() == std::char_traits<char>::eof();
+}
+
+static bool decodePacket(ENetPacket *enetPacket, quantizedPositionPacket_t *packet) {
+  if (enetPacket == nullptr) {
+    return false;
+  }
+
+  bool decoded = decode(std::string((const char *)enetPacket->data, enetPacket->dataLength), packet);
+  enet_packet_destroy(enetPacket);
+
+  return decoded;
+}
+
+static bool acknowledge(Client &client, uint32_t frame) {
+  // the client sends the frame in native byte order like cereal
+  ENetPacket *packet = enet_packet_create(&frame, sizeof(frame), 0);
+  bool acknowledged = client.handlePositionAck(packet);
+  enet_packet_destroy(packet);
+
+  return acknowledged;
+}
+
+static bool testRoundTrip() {
+  quantizedPositionPacket_t packet;
+  packet.frame = 42;
+  packet.baseFrame = 40;
+  packet.x = 1.5f;
+  packet.y = -2.25f;
+  packet.z = 100;
+  packet.rotation = -3.14f;
+  packet.positions.push_back({ 7, POSITION_UPDATE_FLAG_FULL, INT16_MIN, 0, INT16_MAX, UINT16_MAX });
+  packet.positions.push_back({ 8, 0, INT8_MIN, -1, INT8_MAX, 0 });
+
+  ENetPacket *enetPacket = createPacket(packet, 0);
+  quantizedPositionPacket_t result;
+
+  if (decodePacket(enetPacket, &result) == false) {
+    std::cerr << "[TEST] Quantized position packet can't be read" << std::endl;
+    return false;
+  }
+
+  if (result.frame != packet.frame || result.baseFrame != packet.baseFrame || result.x != packet.x || result.y != packet.y ||
+      result.z != packet.z || result.rotation != packet.rotation || result.positions.size() != packet.positions.size()) {
+    std::cerr << "[TEST] Quantized position packet header doesn't match" << std::endl;
+    return false;
+  }
+
+  for (size_t i = 0; i < packet.positions.size(); i++) {
+    const quantizedPositionUpdate_t &expected = packet.positions[i];
+    const quantizedPositionUpdate_t &update = result.positions[i];
+
+    if (update.teamspeakId != expected.teamspeakId || update.flags != expected.flags || update.x != expected.x ||
+        update.y != expected.y || update.z != expected.z || update.voiceRange != expected.voiceRange) {
+      std::cerr << "[TEST] Quantized position update " << i << " doesn't match" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool testKeyframes() {
+  Client listener(nullptr, 1, 1);
+  Client speaker(nullptr, 2, 2);
+  listener.setHandle(makeClientHandle(0, 0));
+  speaker.setHandle(makeClientHandle(1, 0));
+  listener.setQuantizedPositions(true);
+
+  // a voice range of 10 keeps the relative positions unscaled
+  speaker.setVoiceRange(10);
+  listener.addAudibleClient(&speaker);
+
+  std::vector<Client *> slotClients = { &listener, &speaker };
+  std::vector<referenceChange_t> referenceChanges;
+  uint64_t tick = 0;
+
+  auto nextPacket = [&](quantizedPositionPacket_t *packet) {
+    tick++;
+    listener.updateMovement(tick, 0, 0);
+    speaker.updateMovement(tick, 0, 0);
+    listener.buildUpdatePacket(slotClients, referenceChanges);
+
+    return decodePacket(listener.createPositionPacket(slotClients, tick, 1, 1, 1), packet) && packet->positions.size() == 1;
+  };
+
+  quantizedPositionPacket_t packet;
+
+  // keyframes are repeated until one is acknowledged
+  for (uint32_t frame = 1; frame <= 2; frame++) {
+    if (nextPacket(&packet) == false || packet.frame != frame || packet.baseFrame != frame || packet.positions[0].flags != POSITION_UPDATE_FLAG_FULL) {
+      std::cerr << "[TEST] Frame " << frame << " is no keyframe" << std::endl;
+      return false;
+    }
+  }
+
+  if (acknowledge(listener, 2) == false || acknowledge(listener, 1)) {
+    std::cerr << "[TEST] Keyframe acknowledgements aren't ordered" << std::endl;
+    return false;
+  }
+
+  if (nextPacket(&packet) == false || packet.baseFrame != 2 || packet.positions[0].flags != 0 || packet.positions[0].x != 0) {
+    std::cerr << "[TEST] Unmoved speaker isn't sent as delta" << std::endl;
+    return false;
+  }
+
+  // a quarter meter is 64 units of the 8 bit delta
+  speaker.setPosition(linalg::aliases::float3(0.25f, 0, 0));
+
+  if (nextPacket(&packet) == false || packet.baseFrame != 2 || packet.positions[0].flags != 0 || packet.positions[0].x != 64) {
+    std::cerr << "[TEST] Small movement isn't sent as delta" << std::endl;
+    return false;
+  }
+
+  // deltas out of the 8 bit range fall back to absolute values
+  speaker.setPosition(linalg::aliases::float3(1.25f, 0, 0));
+
+  if (nextPacket(&packet) == false || packet.baseFrame != 2 || packet.positions[0].flags != POSITION_UPDATE_FLAG_FULL ||
+      packet.positions[0].x != quantizeCoordinate(1.25f) || packet.positions[0].voiceRange != quantizeVoiceRange(10)) {
+    std::cerr << "[TEST] Large movement doesn't fall back to a full update" << std::endl;
+    return false;
+  }
+
+  // the acknowledged keyframe stays the base until the history wrapped around
+  uint32_t evictingFrame = 2 + POSITION_KEYFRAME_INTERVAL * POSITION_KEYFRAME_HISTORY;
+
+  while (packet.frame + 1 < evictingFrame) {
+    if (nextPacket(&packet) == false) {
+      return false;
+    }
+
+    bool keyframe = (packet.frame - 2) % POSITION_KEYFRAME_INTERVAL == 0;
+
+    if ((keyframe && packet.baseFrame != packet.frame) || (keyframe == false && packet.baseFrame != 2)) {
+      std::cerr << "[TEST] Frame " << packet.frame << " has base frame " << packet.baseFrame << std::endl;
+      return false;
+    }
+  }
+
+  // keyframes resume once the acknowledged one is replaced
+  for (uint32_t frame = evictingFrame; frame <= evictingFrame + 1; frame++) {
+    if (nextPacket(&packet) == false || packet.frame != frame || packet.baseFrame != frame) {
+      std::cerr << "[TEST] Frame " << frame << " after the evicted keyframe is no keyframe" << std::endl;
+      return false;
+    }
+  }
+
+  if (acknowledge(listener, 2)) {
+    std::cerr << "[TEST] Evicted keyframe was acknowledged" << std::endl;
+    return false;
+  }
+
+  if (acknowledge(listener, evictingFrame + 1) == false || nextPacket(&packet) == false || packet.baseFrame != evictingFrame + 1 ||
+      packet.positions[0].flags != 0) {
+    std::cerr << "[TEST] Deltas don't continue after a new acknowledgement" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool test_quantizedPositions() {
+  if (testRoundTrip() == false || testKeyframes() == false) {
+    return false;
+  }
+
+  std::cout << "[TEST] Quantized position packets match" << std::endl;
+  return true;
+}
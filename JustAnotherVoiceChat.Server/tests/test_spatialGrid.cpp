@@ -0,0 +1,96 @@
+/*
+ * File: tests/test_spatialGrid.cpp
+ * Date: 16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2018 JustAnotherVoiceChat
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "test_spatialGrid.h"
+
+#include "spatialGrid.h"
+#include "client.h"
+
+#include <iostream>
+#include <memory>
+#include <limits>
+#include <string.h>
+
+using namespace justAnotherVoiceChat;
+
+static bool compareCellKeys(const SpatialGrid &grid, linalg::aliases::float3 position, linalg::aliases::float3 expectedPosition, const char *name) {
+  uint64_t cellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+  uint64_t expectedCellKeys[SPATIAL_GRID_NEIGHBOUR_CELLS];
+
+  grid.neighbourCellKeys(position, 0, cellKeys);
+  grid.neighbourCellKeys(expectedPosition, 0, expectedCellKeys);
+
+  if (memcmp(cellKeys, expectedCellKeys, sizeof(cellKeys)) != 0) {
+    std::cerr << "[TEST] Cells of " << name << " position don't match" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool test_spatialGrid() {
+  SpatialGrid grid(10);
+
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  float infinity = std::numeric_limits<float>::infinity();
+
+  // positions out of the coordinate range end up in the outermost cells
+  if (compareCellKeys(grid, linalg::aliases::float3(nan, 5, 0), linalg::aliases::float3(5, 5, 0), "nan") == false ||
+      compareCellKeys(grid, linalg::aliases::float3(infinity, 5, 0), linalg::aliases::float3(1e30f, 5, 0), "infinite") == false ||
+      compareCellKeys(grid, linalg::aliases::float3(5, -infinity, 0), linalg::aliases::float3(5, -1e30f, 0), "negative infinite") == false) {
+    return false;
+  }
+
+  if (grid.isNeighbour(linalg::aliases::float3(infinity, 0, 0), 0, linalg::aliases::float3(-infinity, 0, 0), 0)) {
+    std::cerr << "[TEST] Opposite infinite positions are neighbours" << std::endl;
+    return false;
+  }
+
+  // clients at invalid positions can still be moved and removed
+  auto client = std::make_shared<Client>(nullptr, 1, 1);
+  client->setPosition(linalg::aliases::float3(nan, infinity, 0));
+  grid.insertClient(client);
+
+  client->setPosition(linalg::aliases::float3(-infinity, 1e30f, 0));
+  grid.updateClient(client);
+
+  if (grid.cells().size() != 1) {
+    std::cerr << "[TEST] Grid has " << grid.cells().size() << " cells for one client" << std::endl;
+    return false;
+  }
+
+  grid.removeClient(client);
+
+  if (grid.cells().empty() == false) {
+    std::cerr << "[TEST] Grid keeps a cell of a removed client" << std::endl;
+    return false;
+  }
+
+  std::cout << "[TEST] Spatial grid handles invalid positions" << std::endl;
+  return true;
+}